@@ -0,0 +1,578 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "matrix.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Benchmark of the matrix library: sweeps matrix sizes and thread counts
+    for multiplication, transpose, element-wise operations and determinant,
+    and reports GFLOPS, GB/s and the percentage of the machine peak measured
+    at startup. The results can be written as JSON to compare runs.
+    Run with --help for the options.
+*/
+
+/* Minimum time in seconds spent measuring one operation at one size */
+#ifndef BENCHMARK_MIN_TIME
+#define BENCHMARK_MIN_TIME 0.2
+#endif
+
+/* Minimum number of timed repetitions of one operation at one size */
+#ifndef BENCHMARK_MIN_REPEATS
+#define BENCHMARK_MIN_REPEATS 3
+#endif
+
+/* Minimum elements of each of the three arrays of the bandwidth test (32 MiB each);
+   every array is also made at least as large as the last-level cache */
+#ifndef BENCHMARK_STREAM_ELEMENTS
+#define BENCHMARK_STREAM_ELEMENTS (1 << 22)
+#endif
+
+/* Last-level cache size assumed when the system does not report it */
+#ifndef BENCHMARK_DEFAULT_CACHE_BYTES
+#define BENCHMARK_DEFAULT_CACHE_BYTES (32u << 20)
+#endif
+
+/* Iterations of the register-only loop of the FLOP peak test per work item */
+#ifndef BENCHMARK_PEAK_ITERATIONS
+#define BENCHMARK_PEAK_ITERATIONS 2000000
+#endif
+
+/* Maximum number of values in the --sizes and --threads lists */
+#define BENCHMARK_MAX_VALUES 32
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Current time of the monotonic clock in seconds.
+*/
+static double now(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/*
+    Operands of the benchmarked operations: three n × n aligned matrices.
+*/
+typedef struct {
+    matrix* a;
+    matrix* b;
+    matrix* c;
+    double sink;    /* Results of the determinant, kept so it is not optimized away */
+} benchmarkData;
+
+static void runMul(benchmarkData* d){ matrixMulInto(d->c, d->a, d->b); }
+static void runTranspose(benchmarkData* d){ matrixTransposeInto(d->c, d->a); }
+static void runAdd(benchmarkData* d){ matrixAddInto(d->c, d->a, d->b); }
+static void runScale(benchmarkData* d){ matrixMulScalarInto(d->c, d->a, 1.0000001); }
+static void runDet(benchmarkData* d){ d->sink += matrixDet(d->a); }
+
+/*
+    Floating-point operations and bytes moved by one run at size n. The byte
+    counts are the compulsory traffic: every operand read and every result
+    written once. The determinant copies its operand before factorizing it.
+*/
+static double mulFlops(double n){ return 2 * n * n * n; }
+static double detFlops(double n){ return 2 * n * n * n / 3; }
+static double elementFlops(double n){ return n * n; }
+static double noFlops(double n){ (void)n; return 0; }
+static double twoMatrixBytes(double n){ return 2 * n * n * sizeof(double); }
+static double threeMatrixBytes(double n){ return 3 * n * n * sizeof(double); }
+
+/*
+    A benchmarked operation. Compute-bound operations are compared with the
+    FLOP peak, the others with the memory bandwidth peak.
+*/
+typedef struct {
+    const char* name;
+    void (*run)(benchmarkData* d);
+    double (*flops)(double n);
+    double (*bytes)(double n);
+    int computeBound;
+} benchmarkOp;
+
+static const benchmarkOp operations[] = {
+    {"mul",         runMul,         mulFlops,       threeMatrixBytes,   1},
+    {"transpose",   runTranspose,   noFlops,        twoMatrixBytes,     0},
+    {"add",         runAdd,         elementFlops,   threeMatrixBytes,   0},
+    {"scale",       runScale,       elementFlops,   twoMatrixBytes,     0},
+    {"det",         runDet,         detFlops,       twoMatrixBytes,     1},
+};
+
+#define OPERATION_COUNT ((int)(sizeof(operations) / sizeof(operations[0])))
+
+/*
+    Register-only loop of independent multiply-adds, enough chains to hide
+    the latency of two FMA units. The chains are unrolled so the accumulators
+    stay in registers. Returns its accumulators summed so the loop
+    is kept; every iteration performs flopsPerIteration operations.
+*/
+#define PEAK_CHAINS 12
+
+static double peakLoopScalar(long iterations, int* flopsPerIteration){
+    double acc[PEAK_CHAINS];
+    for(int j = 0; j < PEAK_CHAINS; j++){
+        acc[j] = j;
+    }
+    const double x = 0.999999, y = 1e-9;
+    for(long i = 0; i < iterations; i++){
+        #pragma GCC unroll 16
+        for(int j = 0; j < PEAK_CHAINS; j++){
+            acc[j] = acc[j] * x + y;
+        }
+    }
+    double sum = 0;
+    for(int j = 0; j < PEAK_CHAINS; j++){
+        sum += acc[j];
+    }
+    *flopsPerIteration = 2 * PEAK_CHAINS;
+    return sum;
+}
+
+#ifdef MATRIX_X86_SIMD
+#define DEFINE_PEAK_LOOP(NAME, TARGET, VEC, LANES, SET1, FMA, STORE)            \
+TARGET static double NAME(long iterations, int* flopsPerIteration){             \
+    VEC acc[PEAK_CHAINS];                                                       \
+    for(int j = 0; j < PEAK_CHAINS; j++){                                       \
+        acc[j] = SET1((double)j);                                               \
+    }                                                                           \
+    const VEC x = SET1(0.999999), y = SET1(1e-9);                               \
+    for(long i = 0; i < iterations; i++){                                       \
+        _Pragma("GCC unroll 16")                                                \
+        for(int j = 0; j < PEAK_CHAINS; j++){                                   \
+            acc[j] = FMA(acc[j], x, y);                                         \
+        }                                                                       \
+    }                                                                           \
+    double lanes[LANES], sum = 0;                                               \
+    for(int j = 0; j < PEAK_CHAINS; j++){                                       \
+        STORE(lanes, acc[j]);                                                   \
+        for(int l = 0; l < LANES; l++){                                         \
+            sum += lanes[l];                                                    \
+        }                                                                       \
+    }                                                                           \
+    *flopsPerIteration = 2 * LANES * PEAK_CHAINS;                               \
+    return sum;                                                                 \
+}
+
+DEFINE_PEAK_LOOP(peakLoopAvx2, __attribute__((target("avx2,fma"))), __m256d, 4,
+                 _mm256_set1_pd, _mm256_fmadd_pd, _mm256_storeu_pd)
+DEFINE_PEAK_LOOP(peakLoopAvx512, __attribute__((target("avx512f"))), __m512d, 8,
+                 _mm512_set1_pd, _mm512_fmadd_pd, _mm512_storeu_pd)
+#endif
+
+typedef double (*peakLoopFn)(long iterations, int* flopsPerIteration);
+
+/*
+    Select the widest peak loop supported by the running CPU and name its instruction set.
+*/
+static peakLoopFn selectPeakLoop(const char** isa){
+#ifdef MATRIX_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")){
+        *isa = "avx512f";
+        return peakLoopAvx512;
+    }
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        *isa = "avx2+fma";
+        return peakLoopAvx2;
+    }
+#endif
+    *isa = "scalar";
+    return peakLoopScalar;
+}
+
+/*
+    Size in bytes of the last-level cache as reported by the C library,
+    or BENCHMARK_DEFAULT_CACHE_BYTES if it is unknown.
+*/
+static size_t lastLevelCacheBytes(){
+    long bytes = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    if(bytes <= 0){
+        bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    }
+#endif
+    return bytes > 0 ? (size_t)bytes : BENCHMARK_DEFAULT_CACHE_BYTES;
+}
+
+/*
+    Work of the peak tests shared by the worker threads.
+*/
+typedef struct {
+    peakLoopFn loop;
+    double* results;        /* One result per work item of the FLOP test */
+    int flopsPerIteration;
+    const double* x;        /* Arrays of the bandwidth test */
+    const double* y;
+    double* z;
+    size_t chunk;           /* Elements per work item of the bandwidth test */
+} peakWork;
+
+/* Run the register-only loop for work items [begin, end). */
+static void peakFlopsTask(void* arg, int begin, int end){
+    peakWork* w = (peakWork*)arg;
+    for(int i = begin; i < end; i++){
+        int flops;
+        w->results[i] = w->loop(BENCHMARK_PEAK_ITERATIONS, &flops);
+    }
+}
+
+/* Compute z = x * s + y (STREAM triad) over the chunks [begin, end). */
+static void peakTriadTask(void* arg, int begin, int end){
+    peakWork* w = (peakWork*)arg;
+    const elementwiseKernels* k = matrixElementwiseKernels();
+    size_t from = (size_t)begin * w->chunk;
+    size_t to = (size_t)end * w->chunk;
+    k->axpy(to - from, w->x + from, 3.0, w->y + from, w->z + from);
+}
+
+/*
+    Measure the peak FLOP rate and memory bandwidth of the current number of
+    threads, keeping the best of a few runs. The arrays of the bandwidth test
+    are each at least cacheBytes large, so the triad streams from memory.
+*/
+static void measurePeak(peakLoopFn loop, size_t cacheBytes, double* gflops, double* gbs){
+    int threads = matrixGetNumThreads();
+    int items = 4 * threads;
+    peakWork w = {0};
+    w.loop = loop;
+    loop(0, &w.flopsPerIteration);
+    w.results = malloc(items * sizeof(double));
+    // Check if memory allocation was successful
+    if(w.results == NULL){
+        allocationFailure();
+    }
+    *gflops = 0;
+    for(int run = 0; run < 3; run++){
+        double start = now();
+        matrixParallelFor(items, 1, peakFlopsTask, &w);
+        double rate = (double)items * BENCHMARK_PEAK_ITERATIONS * w.flopsPerIteration / (now() - start) * 1e-9;
+        if(rate > *gflops){
+            *gflops = rate;
+        }
+    }
+    free(w.results);
+
+    int chunks = 64;
+    size_t n = BENCHMARK_STREAM_ELEMENTS;
+    if(n < cacheBytes / sizeof(double)){
+        n = cacheBytes / sizeof(double);
+    }
+    // Whole cache lines per chunk, so aligned_alloc gets a multiple of the alignment
+    n = (n + 8 * chunks - 1) / (8 * chunks) * (8 * chunks);
+    double* x = aligned_alloc(MATRIX_ALIGNMENT, n * sizeof(double));
+    double* y = aligned_alloc(MATRIX_ALIGNMENT, n * sizeof(double));
+    double* z = aligned_alloc(MATRIX_ALIGNMENT, n * sizeof(double));
+    // Check if memory allocation was successful
+    if(x == NULL || y == NULL || z == NULL){
+        allocationFailure();
+    }
+    for(size_t i = 0; i < n; i++){
+        x[i] = 1;
+        y[i] = 2;
+        z[i] = 0;
+    }
+    w.x = x;
+    w.y = y;
+    w.z = z;
+    w.chunk = n / chunks;
+    *gbs = 0;
+    for(int run = 0; run < 5; run++){
+        double start = now();
+        matrixParallelFor(chunks, 1, peakTriadTask, &w);
+        double rate = 3.0 * n * sizeof(double) / (now() - start) * 1e-9;
+        if(rate > *gbs){
+            *gbs = rate;
+        }
+    }
+    free(x);
+    free(y);
+    free(z);
+}
+
+/*
+    Run an operation until both the minimum time and the minimum number of
+    repetitions are reached, after one untimed warm-up run.
+    Returns the best time of one run in seconds.
+*/
+static double timeOperation(const benchmarkOp* op, benchmarkData* d, double minTime, int* repeats){
+    op->run(d);
+    double best = -1, total = 0;
+    int count = 0;
+    while(count < BENCHMARK_MIN_REPEATS || total < minTime){
+        double start = now();
+        op->run(d);
+        double elapsed = now() - start;
+        if(best < 0 || elapsed < best){
+            best = elapsed;
+        }
+        total += elapsed;
+        count++;
+    }
+    *repeats = count;
+    return best;
+}
+
+/*
+    Percentage of the peak reached by an operation: compute-bound operations
+    against the FLOP peak, memory-bound ones against the memory bandwidth.
+    Memory-bound operations whose data fits in the last-level cache are not
+    limited by memory bandwidth, so they get NAN (reported as n/a). Runs
+    faster than a measured peak only show that it was underestimated, and
+    are capped at 100.
+*/
+static double percentOfPeak(const benchmarkOp* op, int n, double gflops, double gbs,
+                            double peakGflops, double peakGbs, size_t cacheBytes){
+    double percent;
+    if(op->computeBound){
+        percent = 100 * gflops / peakGflops;
+    }
+    else if(op->bytes(n) > cacheBytes){
+        percent = 100 * gbs / peakGbs;
+    }
+    else{
+        return NAN;
+    }
+    return percent < 100 ? percent : 100;
+}
+
+/*
+    Parse a comma-separated list of positive integers.
+    Returns the number of values, or -1 if the list is malformed.
+*/
+static int parseList(const char* text, int* values){
+    int count = 0;
+    const char* p = text;
+    while(*p != '\0'){
+        char* end;
+        long value = strtol(p, &end, 10);
+        if(end == p || value < 1 || value > 1 << 20 || count == BENCHMARK_MAX_VALUES){
+            return -1;
+        }
+        values[count++] = (int)value;
+        if(*end == ','){
+            end++;
+        }
+        else if(*end != '\0'){
+            return -1;
+        }
+        p = end;
+    }
+    return count;
+}
+
+/*
+    Print the command-line options.
+*/
+static void printUsage(const char* program){
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --sizes N,N,...      Matrix sizes (default 64,128,256,512,1024)\n"
+        "  --threads T,T,...    Thread counts (default 1 and the default thread count)\n"
+        "  --ops NAME,...       Operations among mul,transpose,add,scale,det (default all)\n"
+        "  --time SECONDS       Minimum time per measurement (default %g)\n"
+        "  --json PATH          Write the results as JSON to PATH (- for standard output)\n"
+        "  --peak-gflops X      Use X instead of the measured FLOP peak of every thread count\n"
+        "  --peak-gbs X         Use X instead of the measured bandwidth peak of every thread count\n"
+        "  --cache-mib X        Last-level cache size in MiB (default as reported by the system)\n",
+        program, BENCHMARK_MIN_TIME);
+}
+
+/*
+    Find an operation by name. Returns its index, or -1 if there is none.
+*/
+static int findOperation(const char* name, size_t length){
+    for(int i = 0; i < OPERATION_COUNT; i++){
+        if(strlen(operations[i].name) == length && strncmp(operations[i].name, name, length) == 0){
+            return i;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char** argv){
+    int sizes[BENCHMARK_MAX_VALUES] = {64, 128, 256, 512, 1024};
+    int sizeCount = 5;
+    int threads[BENCHMARK_MAX_VALUES];
+    int threadCount = 0;
+    int selected[OPERATION_COUNT];
+    for(int i = 0; i < OPERATION_COUNT; i++){
+        selected[i] = 1;
+    }
+    double minTime = BENCHMARK_MIN_TIME;
+    double fixedGflops = 0, fixedGbs = 0;
+    size_t cacheBytes = lastLevelCacheBytes();
+    const char* jsonPath = NULL;
+
+    for(int i = 1; i < argc; i++){
+        const char* option = argv[i];
+        if(strcmp(option, "--help") == 0){
+            printUsage(argv[0]);
+            return 0;
+        }
+        if(i + 1 == argc){
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        int valid = 1;
+        if(strcmp(option, "--sizes") == 0){
+            valid = (sizeCount = parseList(value, sizes)) > 0;
+        }
+        else if(strcmp(option, "--threads") == 0){
+            valid = (threadCount = parseList(value, threads)) > 0;
+        }
+        else if(strcmp(option, "--ops") == 0){
+            for(int j = 0; j < OPERATION_COUNT; j++){
+                selected[j] = 0;
+            }
+            const char* p = value;
+            while(valid && *p != '\0'){
+                size_t length = strcspn(p, ",");
+                int index = findOperation(p, length);
+                valid = index >= 0;
+                if(valid){
+                    selected[index] = 1;
+                }
+                p += length + (p[length] == ',');
+            }
+        }
+        else if(strcmp(option, "--time") == 0){
+            valid = (minTime = atof(value)) >= 0;
+        }
+        else if(strcmp(option, "--json") == 0){
+            jsonPath = value;
+        }
+        else if(strcmp(option, "--peak-gflops") == 0){
+            valid = (fixedGflops = atof(value)) > 0;
+        }
+        else if(strcmp(option, "--peak-gbs") == 0){
+            valid = (fixedGbs = atof(value)) > 0;
+        }
+        else if(strcmp(option, "--cache-mib") == 0){
+            double mib = atof(value);
+            valid = mib > 0;
+            cacheBytes = (size_t)(mib * 1024 * 1024);
+        }
+        else{
+            valid = 0;
+        }
+        if(!valid){
+            fprintf(stderr, "Invalid option %s %s.\n", option, value);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Default to one thread and the default thread count
+    if(threadCount == 0){
+        threads[threadCount++] = 1;
+        int available = matrixGetNumThreads();
+        if(available > 1){
+            threads[threadCount++] = available;
+        }
+    }
+
+    FILE* json = NULL;
+    if(jsonPath != NULL){
+        json = strcmp(jsonPath, "-") == 0 ? stdout : fopen(jsonPath, "w");
+        if(json == NULL){
+            fprintf(stderr, "Cannot open %s for writing.\n", jsonPath);
+            return 1;
+        }
+    }
+    // The table goes to standard error when the JSON takes standard output
+    FILE* table = json == stdout ? stderr : stdout;
+
+    const char* isa;
+    peakLoopFn loop = selectPeakLoop(&isa);
+    if(json != NULL){
+        fprintf(json, "{\n  \"isa\": \"%s\",\n  \"minTime\": %g,\n  \"cacheBytes\": %zu,\n  \"results\": [", isa, minTime, cacheBytes);
+    }
+    int first = 1;
+
+    for(int t = 0; t < threadCount; t++){
+        matrixSetNumThreads(threads[t]);
+        double peakGflops = fixedGflops, peakGbs = fixedGbs;
+        if(peakGflops == 0 || peakGbs == 0){
+            double gflops, gbs;
+            measurePeak(loop, cacheBytes, &gflops, &gbs);
+            peakGflops = fixedGflops > 0 ? fixedGflops : gflops;
+            peakGbs = fixedGbs > 0 ? fixedGbs : gbs;
+        }
+        fprintf(table, "threads %d: peak %.1f GFLOPS (%s), %.1f GB/s\n", threads[t], peakGflops, isa, peakGbs);
+        fprintf(table, "%-10s %6s %12s %10s %10s %8s\n", "op", "size", "seconds", "GFLOPS", "GB/s", "% peak");
+
+        for(int s = 0; s < sizeCount; s++){
+            int n = sizes[s];
+            benchmarkData d;
+            d.a = matrixCreateWith(n, n, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+            d.b = matrixCreateWith(n, n, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+            d.c = matrixCreateWith(n, n, MATRIX_CREATE_ALIGNED);
+            d.sink = 0;
+            // Diagonally dominant operands keep the determinant finite and the pivots stable
+            for(int i = 0; i < n; i++){
+                for(int j = 0; j < n; j++){
+                    d.a->data[MATRIX_ADDR(d.a, i, j)] = (i == j ? 2.0 : 0.0) + (double)((i * 7 + j * 13) % 17) / (17.0 * n);
+                    d.b->data[MATRIX_ADDR(d.b, i, j)] = (double)((i * 11 + j * 5) % 19) / 19.0;
+                }
+            }
+
+            for(int o = 0; o < OPERATION_COUNT; o++){
+                if(!selected[o]){
+                    continue;
+                }
+                const benchmarkOp* op = &operations[o];
+                int repeats;
+                double seconds = timeOperation(op, &d, minTime, &repeats);
+                double gflops = op->flops(n) / seconds * 1e-9;
+                double gbs = op->bytes(n) / seconds * 1e-9;
+                double percent = percentOfPeak(op, n, gflops, gbs, peakGflops, peakGbs, cacheBytes);
+                char percentText[16] = "n/a";
+                if(!isnan(percent)){
+                    snprintf(percentText, sizeof(percentText), "%.1f%%", percent);
+                }
+                fprintf(table, "%-10s %6d %12.6f %10.2f %10.2f %8s\n", op->name, n, seconds, gflops, gbs, percentText);
+                if(json != NULL){
+                    char percentJson[16] = "null";
+                    if(!isnan(percent)){
+                        snprintf(percentJson, sizeof(percentJson), "%.4g", percent);
+                    }
+                    fprintf(json, "%s\n    {\"op\": \"%s\", \"size\": %d, \"threads\": %d, \"repeats\": %d, "
+                            "\"seconds\": %.9g, \"gflops\": %.6g, \"gbs\": %.6g, \"percentOfPeak\": %s, "
+                            "\"peakGflops\": %.6g, \"peakGbs\": %.6g, \"bound\": \"%s\"}",
+                            first ? "" : ",", op->name, n, threads[t], repeats, seconds, gflops, gbs, percentJson,
+                            peakGflops, peakGbs, op->computeBound ? "compute" : "memory");
+                    first = 0;
+                }
+            }
+            matrixDelete(d.a);
+            matrixDelete(d.b);
+            matrixDelete(d.c);
+        }
+        fprintf(table, "\n");
+    }
+
+    if(json != NULL){
+        fprintf(json, "\n  ]\n}\n");
+        if(json != stdout){
+            fclose(json);
+        }
+    }
+    return 0;
+}
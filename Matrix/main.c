@@ -1,5 +1,14 @@
 #include <stdio.h>
 #include "matrix.h"
+#include "sparse_matrix.h"
+#include "matrix_expr.h"
+#include "matrix_io.h"
+#include "matrix_typed.h"
+#include "matrix_batch.h"
+#include "matrix_vector.h"
+#include "matrix_solve.h"
+#include "matrix_arena.h"
+#include "matrix_reduce.h"
 
 int main(){
     // Create a 4x2 matrix
@@ -53,6 +62,13 @@ int main(){
     matrix* m7 = matrixSub(m6, m4);
     matrixPrint(m7);
 
+    // Evaluate 2 * m3 + (m4 - 1) lazily, in one pass without temporaries
+    matrixExpr* e = matrixExprAdd(matrixExprScale(matrixExprMatrix(m3), 2),
+                                  matrixExprSub(matrixExprMatrix(m4), matrixExprScalar(1)));
+    matrixExprEvalInto(m7, e);
+    matrixPrint(m7);
+    matrixExprDelete(e);
+
     // Delete matrices to free memory
     matrixDelete(m);
     matrixDelete(m2);
@@ -79,11 +95,184 @@ int main(){
     }
     matrixPrint(m);
 
+    // View the lower-right 3x3 block without copying and scale it in place
+    matrix* block = matrixView(m, 2, 2, 3, 3);
+    matrixMulScalarInto(block, block, 10);
+    matrixPrint(m);
+    matrixMulScalarInto(block, block, 0.1);
+    matrixDelete(block);
+
+    // Save the matrix in the binary format and map it back without copying
+    if(matrixSave(m, "matrix.bin") == 0){
+        matrix* mapped = matrixMap("matrix.bin", 1);
+        printf("Mapped value at [%d, %d] is %lf\n", 4, 2, matrixGetValue(mapped, 4, 2));
+        matrixUnmap(mapped);
+        // Square the saved matrix file by file, as done for operands larger than memory
+        if(matrixMulFiles("matrix.bin", "matrix.bin", "square.bin", 0) == 0){
+            matrix* square = matrixLoad("square.bin");
+            printf("Out-of-core square at [%d, %d] is %lf\n", 0, 0, matrixGetValue(square, 0, 0));
+            matrixDelete(square);
+        }
+    }
+
+    // Write a small CSV file with a header line and load it back
+    FILE* csv = fopen("matrix.csv", "w");
+    if(csv != NULL){
+        fprintf(csv, "x,y\n1.5,2\n-3,4e2\n");
+        fclose(csv);
+        matrix* loaded = matrixLoadCsv("matrix.csv", ',', 1);
+        matrixPrint(loaded);
+        matrixDelete(loaded);
+    }
+
+    // The same values separated by tabs, then by runs of spaces
+    csv = fopen("matrix.csv", "w");
+    if(csv != NULL){
+        fprintf(csv, "1.5\t2\n-3\t4e2\n");
+        fclose(csv);
+        matrix* loaded = matrixLoadCsv("matrix.csv", '\t', 0);
+        matrixPrint(loaded);
+        matrixDelete(loaded);
+    }
+    csv = fopen("matrix.csv", "w");
+    if(csv != NULL){
+        fprintf(csv, "  1.5   2\n-3 4e2  \n");
+        fclose(csv);
+        matrix* loaded = matrixLoadCsv("matrix.csv", ' ', 0);
+        matrixPrint(loaded);
+        matrixDelete(loaded);
+    }
+
+    // Convert the matrix to single precision and integers, square the integer one
+    matrixF32* mf = matrixF32FromF64(m);
+    matrixI32* mi = matrixI32FromF32(mf);
+    matrixI32* mi2 = matrixI32Mul(mi, mi);
+    matrixI32Print(mi2);
+    matrixF32Delete(mf);
+    matrixI32Delete(mi);
+    matrixI32Delete(mi2);
+
+    // Multiply the matrix by a vector of ones, then by its transpose
+    vector* ones = vectorCreate(m->cols);
+    for(int i = 0; i < ones->size; i++){
+        vectorSetValue(ones, i, 1);
+    }
+    vector* rowSums = matrixMulVector(m, ones);
+    vectorPrint(rowSums);
+    matrixGemvTransposed(1.0, m, rowSums, 0.0, ones);
+    printf("Norm of the product is %.2lf\n", vectorNorm(ones));
+    vectorDelete(ones);
+    vectorDelete(rowSums);
+
+    // Factorize the matrix once and solve m * x = (row sums of m): the solution is all ones
+    luFactor* lu = luFactorCreate(m);
+    if(lu != NULL){
+        vector* b = vectorCreate(m->rows);
+        for(int i = 0; i < m->rows; i++){
+            for(int j = 0; j < m->cols; j++){
+                vectorSetValue(b, i, vectorGetValue(b, i) + matrixGetValue(m, i, j));
+            }
+        }
+        luFactorSolveVector(lu, b);
+        vectorPrint(b);
+        vectorDelete(b);
+        luFactorDelete(lu);
+    }
+
+    // Fit a line y = c0 + c1 * x through four points by least squares (QR)
+    matrix* design = matrixCreate(4, 2);
+    matrix* observed = matrixCreate(4, 1);
+    double points[4][2] = {{0, 1.1}, {1, 2.9}, {2, 5.2}, {3, 6.8}};
+    for(int i = 0; i < 4; i++){
+        matrixSetValue(design, i, 0, 1);
+        matrixSetValue(design, i, 1, points[i][0]);
+        matrixSetValue(observed, i, 0, points[i][1]);
+    }
+    matrix* coefficients = matrixLeastSquares(design, observed);
+    if(coefficients != NULL){
+        printf("Fitted line is y = %.2lf + %.2lf * x\n", matrixGetValue(coefficients, 0, 0), matrixGetValue(coefficients, 1, 0));
+        matrixDelete(coefficients);
+    }
+    matrixDelete(design);
+    matrixDelete(observed);
+
+    // Long-run state of a two-state Markov chain: raise the transition matrix to a large power
+    matrix* transition = matrixCreate(2, 2);
+    matrixSetValue(transition, 0, 0, 0.9);
+    matrixSetValue(transition, 0, 1, 0.1);
+    matrixSetValue(transition, 1, 0, 0.5);
+    matrixSetValue(transition, 1, 1, 0.5);
+    matrix* longRun = matrixPow(transition, 1000);
+    matrixPrint(longRun);
+    matrixDelete(longRun);
+    matrixDelete(transition);
+
+    // Build temporaries in an arena; one reset per iteration frees them all
+    matrixArena* arena = matrixArenaCreate(0);
+    for(int iteration = 0; iteration < 3; iteration++){
+        matrix* t = matrixArenaMatrix(arena, m->rows, m->cols, MATRIX_CREATE_UNINITIALIZED);
+        matrixTransposeInto(t, m);
+        matrix* sum = matrixArenaMatrix(arena, m->rows, m->cols, MATRIX_CREATE_UNINITIALIZED);
+        matrixAddInto(sum, m, t);
+        printf("Symmetric part at [%d, %d] is %.2lf\n", 0, 1, matrixGetValue(sum, 0, 1) / 2);
+        matrixArenaReset(arena);
+    }
+    matrixArenaDelete(arena);
+
+    // Reduce the matrix: column sums, norm and position of the largest element
+    vector* colSums = matrixReduceCols(m, MATRIX_REDUCE_SUM);
+    vectorPrint(colSums);
+    vectorDelete(colSums);
+    int maxRow, maxCol;
+    matrixArgMax(m, &maxRow, &maxCol);
+    printf("Norm of matrix is %.2lf, largest element at [%d, %d]\n", matrixNorm(m), maxRow, maxCol);
+
+    // Compute determinant using LU decomposition (the matrix is not modified)
+    printf("Determinant of matrix is %.2lf\n", matrixDet(m));
+
     // Compute determinant using Chio's method
-    printf("Determinant of matrix is %.2lf\n", matrixDetChio(m));
+    printf("Determinant of matrix (Chio) is %.2lf\n", matrixDetChio(m));
 
     // Delete last matrix
     matrixDelete(m);
 
+    // Compute the determinants of 1000 rotation-and-scale 2x2 matrices at once
+    matrixBatch* batch = matrixBatchCreate(1000, 2, 2);
+    for(int k = 0; k < batch->count; k++){
+        matrixBatchSetValue(batch, k, 0, 0, k);
+        matrixBatchSetValue(batch, k, 0, 1, -1);
+        matrixBatchSetValue(batch, k, 1, 0, 1);
+        matrixBatchSetValue(batch, k, 1, 1, k);
+    }
+    matrixBatch* squares = matrixBatchMul(batch, batch);
+    double dets[1000];
+    matrixBatchDet(squares, dets);
+    printf("Determinant of the squared batch matrix %d is %.2lf\n", 3, dets[3]);
+    matrixBatchDelete(batch);
+    matrixBatchDelete(squares);
+
+    // Create a 4x4 sparse matrix from (row, column, value) triplets
+    int rowIdx[] = {0, 1, 2, 3, 3};
+    int colIdx[] = {0, 2, 1, 0, 3};
+    double nonzeros[] = {1, 2, 3, 4, 5};
+    sparseMatrix* s = sparseMatrixFromTriplets(4, 4, 5, rowIdx, colIdx, nonzeros);
+    sparseMatrixPrint(s);
+
+    // Multiply the sparse matrix by a dense vector
+    double x[4] = {1, 1, 1, 1};
+    double y[4];
+    sparseMatrixMulVector(s, x, y);
+    printf("Sparse matrix times ones is [%.2lf %.2lf %.2lf %.2lf]\n", y[0], y[1], y[2], y[3]);
+
+    // Add the sparse matrix to itself and convert the sum to a dense matrix
+    sparseMatrix* s2 = sparseMatrixAdd(s, s);
+    m = sparseMatrixToDense(s2);
+    matrixPrint(m);
+
+    // Delete sparse matrices
+    sparseMatrixDelete(s);
+    sparseMatrixDelete(s2);
+    matrixDelete(m);
+
     return 0;
 }
\ No newline at end of file
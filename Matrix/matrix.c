@@ -1,7 +1,71 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "matrix.h"
+#include "thread_pool.h"
+#include "matrix_kernels.h"
+#include "matrix_arena.h"
+
+/*
+    Blocking parameters of the packed GEMM kernel.
+    MR x NR is the register tile computed by the micro-kernel,
+    KC x NR panels of B stay in L1, MC x KC blocks of A stay in L2
+    and KC x NC panels of B stay in L3.
+*/
+#define GEMM_MR 6
+#define GEMM_NR 8
+#ifndef MATRIX_GEMM_MC
+#define MATRIX_GEMM_MC 96
+#endif
+#ifndef MATRIX_GEMM_KC
+#define MATRIX_GEMM_KC 256
+#endif
+#ifndef MATRIX_GEMM_NC
+#define MATRIX_GEMM_NC 2048
+#endif
+
+/*
+    Products with fewer multiply-adds (rows * inner * cols) than this
+    are computed by the simple loop, because packing would cost more
+    than it saves.
+*/
+#ifndef MATRIX_GEMM_THRESHOLD
+#define MATRIX_GEMM_THRESHOLD (48 * 48 * 48)
+#endif
+
+/*
+    Products with fewer multiply-adds than this stay on the calling
+    thread, because waking the worker pool would cost more than it saves.
+*/
+#ifndef MATRIX_PARALLEL_THRESHOLD
+#define MATRIX_PARALLEL_THRESHOLD (128 * 128 * 128)
+#endif
+
+/*
+    Default size at or below which the Strassen-Winograd recursion hands
+    its sub-products to the classical kernel. Adjustable at runtime with
+    matrixSetStrassenCutover.
+*/
+#ifndef MATRIX_STRASSEN_CUTOVER
+#define MATRIX_STRASSEN_CUTOVER 1024
+#endif
+
+/*
+    Side of the square tiles used by the blocked transpose, chosen so
+    that a source and a destination tile fit in L1 together.
+*/
+#ifndef MATRIX_TRANSPOSE_BLOCK
+#define MATRIX_TRANSPOSE_BLOCK 32
+#endif
+
+/*
+    Number of columns factorized per panel by the blocked LU decomposition.
+    The trailing update of every panel is a rank-MATRIX_LU_BLOCK GEMM.
+*/
+#ifndef MATRIX_LU_BLOCK
+#define MATRIX_LU_BLOCK 64
+#endif
 
 /*
     Static helper function for handling memory allocation failures,
@@ -12,6 +76,773 @@ _Noreturn static void allocationFailure(){
     exit(EXIT_FAILURE);
 }
 
+/*
+    Thread exit handler freeing a per-thread workspace buffer.
+*/
+static void workspaceFree(void* buffer){
+    double** b = buffer;
+    free(*b);
+    *b = NULL;
+}
+
+/*
+    Return a buffer of at least `count` doubles aligned to a cache line.
+    The buffer is cached per thread in `*buffer` / `*capacity` and only
+    reallocated when it has to grow, so repeated calls do not allocate.
+*/
+static double* workspaceReserve(double** buffer, size_t* capacity, size_t count){
+    if(count > *capacity){
+        // Per-thread buffers are freed when their thread exits
+        if(*buffer == NULL){
+            matrixAtThreadExit(workspaceFree, buffer);
+        }
+        free(*buffer);
+        // aligned_alloc requires the size to be a multiple of the alignment
+        size_t bytes = (count * sizeof(double) + 63) & ~(size_t)63;
+        *buffer = aligned_alloc(64, bytes);
+        if(*buffer == NULL){
+            allocationFailure();
+        }
+        *capacity = bytes / sizeof(double);
+    }
+    return *buffer;
+}
+
+/*
+    Simple i-k-j product c = alpha * a * b + beta * c working directly on the
+    data arrays. Used for small matrices where the blocked kernel does not pay off.
+*/
+static void gemmSimple(int m, int n, int k, double alpha, const double* a, int lda, const double* b, int ldb, double beta, double* c, int ldc){
+    for(int i = 0; i < m; i++){
+        double* ci = c + (size_t)i * ldc;
+        // With beta == 0 the old contents of c are never read
+        for(int j = 0; j < n; j++){
+            ci[j] = beta == 0.0 ? 0.0 : beta * ci[j];
+        }
+        // Walk row i of a and rows of b, so all accesses are sequential
+        for(int p = 0; p < k; p++){
+            double aip = alpha * a[(size_t)i * lda + p];
+            const double* bp = b + (size_t)p * ldb;
+            for(int j = 0; j < n; j++){
+                ci[j] += aip * bp[j];
+            }
+        }
+    }
+}
+
+/*
+    Pack an mc x kc block of a into row panels of GEMM_MR rows.
+    Inside a panel the elements are stored column by column, so the
+    micro-kernel reads them sequentially. Missing rows are zero-padded.
+*/
+static void gemmPackA(int mc, int kc, const double* a, int lda, double* packed){
+    for(int ir = 0; ir < mc; ir += GEMM_MR){
+        int rows = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+        for(int p = 0; p < kc; p++){
+            for(int r = 0; r < GEMM_MR; r++){
+                *packed++ = r < rows ? a[(size_t)(ir + r) * lda + p] : 0.0;
+            }
+        }
+    }
+}
+
+/*
+    Pack a kc x nc panel of b into column panels of GEMM_NR columns,
+    each stored row by row. Missing columns are zero-padded.
+*/
+static void gemmPackB(int kc, int nc, const double* b, int ldb, double* packed){
+    for(int jr = 0; jr < nc; jr += GEMM_NR){
+        int cols = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+        for(int p = 0; p < kc; p++){
+            const double* bp = b + (size_t)p * ldb + jr;
+            for(int j = 0; j < GEMM_NR; j++){
+                *packed++ = j < cols ? bp[j] : 0.0;
+            }
+        }
+    }
+}
+
+/*
+    Write an mr x nr corner of a GEMM_MR x GEMM_NR register tile into c
+    as c = alpha * tile + beta * c. With beta == 0 c is only written.
+*/
+static void gemmStoreTile(const double* tile, double* c, int ldc, int mr, int nr, double alpha, double beta){
+    for(int r = 0; r < mr; r++){
+        double* cr = c + (size_t)r * ldc;
+        for(int j = 0; j < nr; j++){
+            cr[j] = beta == 0.0 ? alpha * tile[r * GEMM_NR + j] : alpha * tile[r * GEMM_NR + j] + beta * cr[j];
+        }
+    }
+}
+
+/*
+    Portable micro-kernel: multiply a packed GEMM_MR x kc panel of a by a
+    packed kc x GEMM_NR panel of b, keeping the tile in local accumulators.
+*/
+static void gemmMicroKernel(int kc, const double* a, const double* b, double* c, int ldc, int mr, int nr, double alpha, double beta){
+    double tile[GEMM_MR * GEMM_NR] = {0.0};
+    for(int p = 0; p < kc; p++){
+        for(int r = 0; r < GEMM_MR; r++){
+            double ar = a[r];
+            for(int j = 0; j < GEMM_NR; j++){
+                tile[r * GEMM_NR + j] += ar * b[j];
+            }
+        }
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+    gemmStoreTile(tile, c, ldc, mr, nr, alpha, beta);
+}
+
+#ifdef MATRIX_X86_SIMD
+/*
+    AVX2/FMA micro-kernel: the 6x8 tile lives in twelve ymm registers,
+    each step broadcasts one element of a and issues two FMAs per row.
+*/
+__attribute__((target("avx2,fma")))
+static void gemmMicroKernelAvx2(int kc, const double* a, const double* b, double* c, int ldc, int mr, int nr, double alpha, double beta){
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for(int p = 0; p < kc; p++){
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d ar;
+        ar = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(ar, b0, c00); c01 = _mm256_fmadd_pd(ar, b1, c01);
+        ar = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ar, b0, c10); c11 = _mm256_fmadd_pd(ar, b1, c11);
+        ar = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ar, b0, c20); c21 = _mm256_fmadd_pd(ar, b1, c21);
+        ar = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ar, b0, c30); c31 = _mm256_fmadd_pd(ar, b1, c31);
+        ar = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ar, b0, c40); c41 = _mm256_fmadd_pd(ar, b1, c41);
+        ar = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ar, b0, c50); c51 = _mm256_fmadd_pd(ar, b1, c51);
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+    // Full tiles go straight to c, edge tiles through a temporary
+    if(mr == GEMM_MR && nr == GEMM_NR){
+        __m256d acc[GEMM_MR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+        __m256d va = _mm256_set1_pd(alpha);
+        __m256d vb = _mm256_set1_pd(beta);
+        for(int r = 0; r < GEMM_MR; r++){
+            double* cr = c + (size_t)r * ldc;
+            acc[r][0] = _mm256_mul_pd(acc[r][0], va);
+            acc[r][1] = _mm256_mul_pd(acc[r][1], va);
+            if(beta != 0.0){
+                acc[r][0] = _mm256_fmadd_pd(vb, _mm256_loadu_pd(cr), acc[r][0]);
+                acc[r][1] = _mm256_fmadd_pd(vb, _mm256_loadu_pd(cr + 4), acc[r][1]);
+            }
+            _mm256_storeu_pd(cr, acc[r][0]);
+            _mm256_storeu_pd(cr + 4, acc[r][1]);
+        }
+        return;
+    }
+    double tile[GEMM_MR * GEMM_NR];
+    _mm256_storeu_pd(tile + 0, c00);  _mm256_storeu_pd(tile + 4, c01);
+    _mm256_storeu_pd(tile + 8, c10);  _mm256_storeu_pd(tile + 12, c11);
+    _mm256_storeu_pd(tile + 16, c20); _mm256_storeu_pd(tile + 20, c21);
+    _mm256_storeu_pd(tile + 24, c30); _mm256_storeu_pd(tile + 28, c31);
+    _mm256_storeu_pd(tile + 32, c40); _mm256_storeu_pd(tile + 36, c41);
+    _mm256_storeu_pd(tile + 40, c50); _mm256_storeu_pd(tile + 44, c51);
+    gemmStoreTile(tile, c, ldc, mr, nr, alpha, beta);
+}
+#endif
+
+typedef void (*gemmMicroKernelFn)(int kc, const double* a, const double* b, double* c, int ldc, int mr, int nr, double alpha, double beta);
+
+/*
+    Pick the fastest micro-kernel supported by the running CPU.
+*/
+static gemmMicroKernelFn gemmSelectMicroKernel(){
+#ifdef MATRIX_X86_SIMD
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return gemmMicroKernelAvx2;
+    }
+#endif
+    return gemmMicroKernel;
+}
+
+/*
+    Arguments shared by the tasks of one parallel step of the blocked GEMM.
+    A step covers one KC x NC panel of b; its output panel of c is split
+    into `rowBlocks` blocks of MC rows times `colGroups` groups of columns.
+*/
+typedef struct {
+    gemmMicroKernelFn kernel;
+    const double* a;        /* First row of a for this step, at column pc */
+    int lda;
+    const double* packB;    /* Packed KC x NC panel of b */
+    double* c;              /* First element of the output panel */
+    int ldc;
+    int m;
+    int nc;
+    int kc;
+    int colGroups;
+    int groupWidth;         /* Columns per group, a multiple of GEMM_NR */
+    double alpha;
+    double beta;
+} gemmStep;
+
+/*
+    Arguments for packing a panel of b in parallel, one task per NR panel.
+*/
+typedef struct {
+    const double* b;
+    int ldb;
+    int kc;
+    int nc;
+    double* packed;
+} gemmPackBStep;
+
+static void gemmPackBTask(void* arg, int begin, int end){
+    gemmPackBStep* step = arg;
+    for(int t = begin; t < end; t++){
+        int jr = t * GEMM_NR;
+        int nr = step->nc - jr < GEMM_NR ? step->nc - jr : GEMM_NR;
+        gemmPackB(step->kc, nr, step->b + jr, step->ldb, step->packed + (size_t)jr * step->kc);
+    }
+}
+
+/*
+    Compute the output blocks [begin, end) of one step. Every task packs
+    its own MC x KC block of a into a per-thread buffer.
+*/
+static void gemmStepTask(void* arg, int begin, int end){
+    static _Thread_local double* packA = NULL;
+    static _Thread_local size_t packACapacity = 0;
+    gemmStep* step = arg;
+
+    workspaceReserve(&packA, &packACapacity, (size_t)(MATRIX_GEMM_MC + GEMM_MR) * MATRIX_GEMM_KC);
+    for(int t = begin; t < end; t++){
+        int ic = (t / step->colGroups) * MATRIX_GEMM_MC;
+        int mc = step->m - ic < MATRIX_GEMM_MC ? step->m - ic : MATRIX_GEMM_MC;
+        int jFirst = (t % step->colGroups) * step->groupWidth;
+        int jLast = jFirst + step->groupWidth < step->nc ? jFirst + step->groupWidth : step->nc;
+        if(jFirst >= jLast){
+            continue;
+        }
+        gemmPackA(mc, step->kc, step->a + (size_t)ic * step->lda, step->lda, packA);
+        for(int jr = jFirst; jr < jLast; jr += GEMM_NR){
+            int nr = step->nc - jr < GEMM_NR ? step->nc - jr : GEMM_NR;
+            for(int ir = 0; ir < mc; ir += GEMM_MR){
+                int mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+                step->kernel(step->kc, packA + (size_t)ir * step->kc, step->packB + (size_t)jr * step->kc,
+                             step->c + (size_t)(ic + ir) * step->ldc + jr, step->ldc, mr, nr, step->alpha, step->beta);
+            }
+        }
+    }
+}
+
+/*
+    Cache-blocked product c = alpha * a * b + beta * c using packed panels of a and b.
+    Loop order follows the classic GotoBLAS scheme: NC columns of b,
+    KC slices of the inner dimension, MC rows of a, then NR x MR tiles.
+    With `threads` > 1 the output panel of every step is split into row
+    blocks (and column groups when there are too few row blocks) which
+    are processed by the worker pool.
+*/
+static void gemmBlocked(int m, int n, int k, double alpha, const double* a, int lda, const double* b, int ldb, double beta, double* c, int ldc, int threads){
+    static _Thread_local double* packB = NULL;
+    static _Thread_local size_t packBCapacity = 0;
+    static gemmMicroKernelFn kernel = NULL;
+
+    if(kernel == NULL){
+        kernel = gemmSelectMicroKernel();
+    }
+    workspaceReserve(&packB, &packBCapacity, (size_t)MATRIX_GEMM_KC * (MATRIX_GEMM_NC + GEMM_NR));
+
+    int rowBlocks = (m + MATRIX_GEMM_MC - 1) / MATRIX_GEMM_MC;
+    for(int jc = 0; jc < n; jc += MATRIX_GEMM_NC){
+        int nc = n - jc < MATRIX_GEMM_NC ? n - jc : MATRIX_GEMM_NC;
+        int panels = (nc + GEMM_NR - 1) / GEMM_NR;
+        // Give every thread a few blocks to balance the load
+        int colGroups = 1;
+        while(rowBlocks * colGroups < 4 * threads && colGroups < panels){
+            colGroups *= 2;
+        }
+        if(colGroups > panels){
+            colGroups = panels;
+        }
+        int groupWidth = (panels + colGroups - 1) / colGroups * GEMM_NR;
+        for(int pc = 0; pc < k; pc += MATRIX_GEMM_KC){
+            int kc = k - pc < MATRIX_GEMM_KC ? k - pc : MATRIX_GEMM_KC;
+            gemmPackBStep pack = {b + (size_t)pc * ldb + jc, ldb, kc, nc, packB};
+            // The first slice applies beta, later slices accumulate into c
+            gemmStep step = {kernel, a + pc, lda, packB, c + jc, ldc, m, nc, kc, colGroups, groupWidth, alpha, pc > 0 ? 1.0 : beta};
+            if(threads > 1){
+                matrixParallelFor(panels, 8, gemmPackBTask, &pack);
+                matrixParallelFor(rowBlocks * colGroups, 1, gemmStepTask, &step);
+            }
+            else{
+                gemmPackBTask(&pack, 0, panels);
+                gemmStepTask(&step, 0, rowBlocks * colGroups);
+            }
+        }
+    }
+}
+
+/*
+    Number of threads worth using for an m x k by k x n product.
+*/
+static int gemmThreads(int m, int n, int k){
+    return (long long)m * n * k < MATRIX_PARALLEL_THRESHOLD ? 1 : matrixGetNumThreads();
+}
+
+/*
+    Compute c = alpha * a * b + beta * c for an m x k matrix a and a k x n
+    matrix b, choosing the kernel from the size of the product.
+    With beta == 0 the previous contents of c are ignored.
+*/
+static void gemm(int m, int n, int k, double alpha, const double* a, int lda, const double* b, int ldb, double beta, double* c, int ldc){
+    if(k == 0 || (long long)m * n * k < MATRIX_GEMM_THRESHOLD){
+        gemmSimple(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+        return;
+    }
+    gemmBlocked(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, gemmThreads(m, n, k));
+}
+
+void matrixGemm(int m, int n, int k, double alpha, const double* a, int lda, const double* b, int ldb, double beta, double* c, int ldc){
+    gemm(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+/*
+    Generate the element-wise kernels for one instruction set.
+    The vector loop processes `width` doubles per step and the
+    remaining elements are handled by a scalar tail loop.
+*/
+#define DEFINE_ELEMENTWISE_KERNELS(suffix, target, vec, width, loadu, storeu, set1, vadd, vsub, vmul) \
+    target static void elementwiseAdd##suffix(size_t n, const double* a, const double* b, double* c){ \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vadd(loadu(a + i), loadu(b + i))); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] + b[i]; \
+        } \
+    } \
+    target static void elementwiseSub##suffix(size_t n, const double* a, const double* b, double* c){ \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vsub(loadu(a + i), loadu(b + i))); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] - b[i]; \
+        } \
+    } \
+    target static void elementwiseAddScalar##suffix(size_t n, const double* a, double s, double* c){ \
+        vec vs = set1(s); \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vadd(loadu(a + i), vs)); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] + s; \
+        } \
+    } \
+    target static void elementwiseMulScalar##suffix(size_t n, const double* a, double s, double* c){ \
+        vec vs = set1(s); \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vmul(loadu(a + i), vs)); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] * s; \
+        } \
+    } \
+    target static void elementwiseMul##suffix(size_t n, const double* a, const double* b, double* c){ \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vmul(loadu(a + i), loadu(b + i))); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] * b[i]; \
+        } \
+    } \
+    target static void elementwiseAxpy##suffix(size_t n, const double* a, double s, const double* b, double* c){ \
+        vec vs = set1(s); \
+        size_t i = 0; \
+        for(; i + (width) <= n; i += (width)){ \
+            storeu(c + i, vadd(vmul(loadu(a + i), vs), loadu(b + i))); \
+        } \
+        for(; i < n; i++){ \
+            c[i] = a[i] * s + b[i]; \
+        } \
+    }
+
+/* Scalar "vector" helpers so the portable fallback shares the generator. */
+#define SCALAR_LOAD(p) (*(p))
+#define SCALAR_STORE(p, v) (*(p) = (v))
+#define SCALAR_SET1(s) (s)
+#define SCALAR_ADD(x, y) ((x) + (y))
+#define SCALAR_SUB(x, y) ((x) - (y))
+#define SCALAR_MUL(x, y) ((x) * (y))
+
+DEFINE_ELEMENTWISE_KERNELS(Scalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SCALAR_ADD, SCALAR_SUB, SCALAR_MUL)
+
+#ifdef MATRIX_X86_SIMD
+DEFINE_ELEMENTWISE_KERNELS(Sse2, __attribute__((target("sse2"))), __m128d, 2,
+                           _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd)
+DEFINE_ELEMENTWISE_KERNELS(Avx2, __attribute__((target("avx2"))), __m256d, 4,
+                           _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd)
+DEFINE_ELEMENTWISE_KERNELS(Avx512, __attribute__((target("avx512f"))), __m512d, 8,
+                           _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd)
+#endif
+
+const elementwiseKernels* matrixElementwiseKernels(){
+    static const elementwiseKernels scalar = {elementwiseAddScalar, elementwiseSubScalar, elementwiseAddScalarScalar, elementwiseMulScalarScalar,
+                                              elementwiseMulScalar, elementwiseAxpyScalar};
+    static const elementwiseKernels* selected = NULL;
+    if(selected != NULL){
+        return selected;
+    }
+    selected = &scalar;
+#ifdef MATRIX_X86_SIMD
+    static const elementwiseKernels sse2 = {elementwiseAddSse2, elementwiseSubSse2, elementwiseAddScalarSse2, elementwiseMulScalarSse2,
+                                            elementwiseMulSse2, elementwiseAxpySse2};
+    static const elementwiseKernels avx2 = {elementwiseAddAvx2, elementwiseSubAvx2, elementwiseAddScalarAvx2, elementwiseMulScalarAvx2,
+                                            elementwiseMulAvx2, elementwiseAxpyAvx2};
+    static const elementwiseKernels avx512 = {elementwiseAddAvx512, elementwiseSubAvx512, elementwiseAddScalarAvx512, elementwiseMulScalarAvx512,
+                                            elementwiseMulAvx512, elementwiseAxpyAvx512};
+    if(__builtin_cpu_supports("avx512f")){
+        selected = &avx512;
+    }
+    else if(__builtin_cpu_supports("avx2")){
+        selected = &avx2;
+    }
+    else if(__builtin_cpu_supports("sse2")){
+        selected = &sse2;
+    }
+#endif
+    return selected;
+}
+
+static int strassenCutover = MATRIX_STRASSEN_CUTOVER;
+
+/*
+    c = a + b (sign > 0) or c = a - b (sign < 0) for rows x cols blocks
+    with independent row strides, using the element-wise kernels per row.
+*/
+static void addBlocks(int rows, int cols, const double* a, int lda, const double* b, int ldb, double* c, int ldc, int sign){
+    elementwiseBinaryFn op = sign > 0 ? matrixElementwiseKernels()->add : matrixElementwiseKernels()->sub;
+    for(int i = 0; i < rows; i++){
+        op((size_t)cols, a + (size_t)i * lda, b + (size_t)i * ldb, c + (size_t)i * ldc);
+    }
+}
+
+/*
+    Number of doubles of workspace needed by strassenRecursive for an
+    m x k by k x n product: three half-size temporaries per level.
+*/
+static size_t strassenWorkspace(int m, int n, int k){
+    size_t total = 0;
+    while(m > strassenCutover && n > strassenCutover && k > strassenCutover){
+        m /= 2;
+        n /= 2;
+        k /= 2;
+        total += (size_t)m * k + (size_t)k * n + (size_t)m * n;
+    }
+    return total;
+}
+
+/*
+    Strassen-Winograd product c = a * b (7 half-size products, 15 additions).
+    Odd dimensions are handled by dynamic peeling: the even part is computed
+    recursively and the last row, column and inner index are fixed up with
+    the classical kernel. The three temporaries of each level (X: m/2 x k/2,
+    Y: k/2 x n/2, Z: m/2 x n/2) are carved from `work`; the rest of `work` is
+    passed to the sub-products, which run one after another and reuse it.
+    Returns the number of recursion levels performed.
+*/
+static int strassenRecursive(int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc, double* work){
+    if(m <= strassenCutover || n <= strassenCutover || k <= strassenCutover){
+        gemm(m, n, k, 1.0, a, lda, b, ldb, 0.0, c, ldc);
+        return 0;
+    }
+    int mh = m / 2, nh = n / 2, kh = k / 2;
+    const double *a11 = a, *a12 = a + kh, *a21 = a + (size_t)mh * lda, *a22 = a21 + kh;
+    const double *b11 = b, *b12 = b + nh, *b21 = b + (size_t)kh * ldb, *b22 = b21 + nh;
+    double *c11 = c, *c12 = c + nh, *c21 = c + (size_t)mh * ldc, *c22 = c21 + nh;
+    double* x = work;
+    double* y = x + (size_t)mh * kh;
+    double* z = y + (size_t)kh * nh;
+    double* rest = z + (size_t)mh * nh;
+    int levels = 0;
+
+    // C21 = P7 = (A11 - A21) * (B22 - B12)
+    addBlocks(mh, kh, a11, lda, a21, lda, x, kh, -1);
+    addBlocks(kh, nh, b22, ldb, b12, ldb, y, nh, -1);
+    levels = strassenRecursive(mh, nh, kh, x, kh, y, nh, c21, ldc, rest);
+    // C22 = P5 = (A21 + A22) * (B12 - B11)
+    addBlocks(mh, kh, a21, lda, a22, lda, x, kh, 1);
+    addBlocks(kh, nh, b12, ldb, b11, ldb, y, nh, -1);
+    strassenRecursive(mh, nh, kh, x, kh, y, nh, c22, ldc, rest);
+    // C12 = P6 = (S1 - A11) * (B22 - T1)
+    addBlocks(mh, kh, x, kh, a11, lda, x, kh, -1);
+    addBlocks(kh, nh, b22, ldb, y, nh, y, nh, -1);
+    strassenRecursive(mh, nh, kh, x, kh, y, nh, c12, ldc, rest);
+    // C11 = P3 = (A12 - S2) * B22
+    addBlocks(mh, kh, a12, lda, x, kh, x, kh, -1);
+    strassenRecursive(mh, nh, kh, x, kh, b22, ldb, c11, ldc, rest);
+    // Z = P1 = A11 * B11
+    strassenRecursive(mh, nh, kh, a11, lda, b11, ldb, z, nh, rest);
+    // U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5
+    addBlocks(mh, nh, z, nh, c12, ldc, c12, ldc, 1);
+    addBlocks(mh, nh, c12, ldc, c21, ldc, c21, ldc, 1);
+    addBlocks(mh, nh, c12, ldc, c22, ldc, c12, ldc, 1);
+    // C12 = U5 = U4 + P3, C22 = U7 = U3 + P5
+    addBlocks(mh, nh, c12, ldc, c11, ldc, c12, ldc, 1);
+    addBlocks(mh, nh, c21, ldc, c22, ldc, c22, ldc, 1);
+    // C11 = P4 = A22 * (T2 - B21), then C21 = U6 = U3 - P4
+    addBlocks(kh, nh, y, nh, b21, ldb, y, nh, -1);
+    strassenRecursive(mh, nh, kh, a22, lda, y, nh, c11, ldc, rest);
+    addBlocks(mh, nh, c21, ldc, c11, ldc, c21, ldc, -1);
+    // C11 = U1 = P1 + P2 = Z + A12 * B21
+    strassenRecursive(mh, nh, kh, a12, lda, b21, ldb, c11, ldc, rest);
+    addBlocks(mh, nh, z, nh, c11, ldc, c11, ldc, 1);
+
+    // Peel the odd inner index, last column and last row
+    if(k > 2 * kh){
+        gemm(2 * mh, 2 * nh, 1, 1.0, a + 2 * kh, lda, b + (size_t)(2 * kh) * ldb, ldb, 1.0, c, ldc);
+    }
+    if(n > 2 * nh){
+        gemm(m, 1, k, 1.0, a, lda, b + 2 * nh, ldb, 0.0, c + 2 * nh, ldc);
+    }
+    if(m > 2 * mh){
+        gemm(1, 2 * nh, k, 1.0, a + (size_t)(2 * mh) * lda, lda, b, ldb, 0.0, c + (size_t)(2 * mh) * ldc, ldc);
+    }
+    return levels + 1;
+}
+
+/*
+    Transpose kernels. A tile kernel writes the transpose of a rows x cols
+    block of src into dst; a swap kernel exchanges the tile at x with the
+    transpose of the tile at y inside one square matrix.
+*/
+typedef void (*transposeTileFn)(int rows, int cols, const double* src, int lds, double* dst, int ldd);
+typedef void (*transposeSwapFn)(int rows, int cols, double* x, double* y, int lda);
+
+static void transposeTileScalar(int rows, int cols, const double* src, int lds, double* dst, int ldd){
+    for(int i = 0; i < rows; i++){
+        for(int j = 0; j < cols; j++){
+            dst[(size_t)j * ldd + i] = src[(size_t)i * lds + j];
+        }
+    }
+}
+
+static void transposeSwapScalar(int rows, int cols, double* x, double* y, int lda){
+    for(int i = 0; i < rows; i++){
+        for(int j = 0; j < cols; j++){
+            double tmp = x[(size_t)i * lda + j];
+            x[(size_t)i * lda + j] = y[(size_t)j * lda + i];
+            y[(size_t)j * lda + i] = tmp;
+        }
+    }
+}
+
+#ifdef MATRIX_X86_SIMD
+/*
+    Transpose four rows of four doubles held in registers: two unpacks
+    interleave pairs of rows, two lane permutes combine the halves.
+*/
+__attribute__((target("avx")))
+static inline void transpose4x4Registers(__m256d* r){
+    __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]);
+    __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]);
+    __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]);
+    __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]);
+    r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+__attribute__((target("avx")))
+static void transposeTileAvx(int rows, int cols, const double* src, int lds, double* dst, int ldd){
+    int j = 0;
+    // Walk along the destination rows so the stores stay sequential
+    for(; j + 4 <= cols; j += 4){
+        int i = 0;
+        for(; i + 4 <= rows; i += 4){
+            __m256d r[4];
+            for(int k = 0; k < 4; k++){
+                r[k] = _mm256_loadu_pd(src + (size_t)(i + k) * lds + j);
+            }
+            transpose4x4Registers(r);
+            for(int k = 0; k < 4; k++){
+                _mm256_storeu_pd(dst + (size_t)(j + k) * ldd + i, r[k]);
+            }
+        }
+        transposeTileScalar(rows - i, 4, src + (size_t)i * lds + j, lds, dst + (size_t)j * ldd + i, ldd);
+    }
+    transposeTileScalar(rows, cols - j, src + j, lds, dst + (size_t)j * ldd, ldd);
+}
+
+__attribute__((target("avx")))
+static void transposeSwapAvx(int rows, int cols, double* x, double* y, int lda){
+    int i = 0;
+    for(; i + 4 <= rows; i += 4){
+        int j = 0;
+        for(; j + 4 <= cols; j += 4){
+            __m256d rx[4], ry[4];
+            for(int k = 0; k < 4; k++){
+                rx[k] = _mm256_loadu_pd(x + (size_t)(i + k) * lda + j);
+                ry[k] = _mm256_loadu_pd(y + (size_t)(j + k) * lda + i);
+            }
+            transpose4x4Registers(rx);
+            transpose4x4Registers(ry);
+            for(int k = 0; k < 4; k++){
+                _mm256_storeu_pd(x + (size_t)(i + k) * lda + j, ry[k]);
+                _mm256_storeu_pd(y + (size_t)(j + k) * lda + i, rx[k]);
+            }
+        }
+        transposeSwapScalar(4, cols - j, x + (size_t)i * lda + j, y + (size_t)j * lda + i, lda);
+    }
+    transposeSwapScalar(rows - i, cols, x + (size_t)i * lda, y + i, lda);
+}
+#endif
+
+/*
+    Out-of-place transpose dst = src^T of a rows x cols matrix, processed
+    in MATRIX_TRANSPOSE_BLOCK tiles so both sides stay cache resident.
+*/
+static void transposeBlocked(int rows, int cols, const double* src, int lds, double* dst, int ldd){
+    transposeTileFn tile = transposeTileScalar;
+#ifdef MATRIX_X86_SIMD
+    if(__builtin_cpu_supports("avx")){
+        tile = transposeTileAvx;
+    }
+#endif
+    for(int ib = 0; ib < rows; ib += MATRIX_TRANSPOSE_BLOCK){
+        int rb = rows - ib < MATRIX_TRANSPOSE_BLOCK ? rows - ib : MATRIX_TRANSPOSE_BLOCK;
+        for(int jb = 0; jb < cols; jb += MATRIX_TRANSPOSE_BLOCK){
+            int cb = cols - jb < MATRIX_TRANSPOSE_BLOCK ? cols - jb : MATRIX_TRANSPOSE_BLOCK;
+            tile(rb, cb, src + (size_t)ib * lds + jb, lds, dst + (size_t)jb * ldd + ib, ldd);
+        }
+    }
+}
+
+/*
+    In-place transpose of an n x n matrix. Tiles above the diagonal are
+    swapped with their mirror tiles below it; diagonal tiles are
+    transposed element by element.
+*/
+static void transposeSquareInPlace(int n, double* a, int lda){
+    transposeSwapFn swap = transposeSwapScalar;
+#ifdef MATRIX_X86_SIMD
+    if(__builtin_cpu_supports("avx")){
+        swap = transposeSwapAvx;
+    }
+#endif
+    for(int ib = 0; ib < n; ib += MATRIX_TRANSPOSE_BLOCK){
+        int rb = n - ib < MATRIX_TRANSPOSE_BLOCK ? n - ib : MATRIX_TRANSPOSE_BLOCK;
+        // Diagonal tile: swap the elements above its diagonal with those below
+        for(int i = ib; i < ib + rb; i++){
+            for(int j = i + 1; j < ib + rb; j++){
+                double tmp = a[(size_t)i * lda + j];
+                a[(size_t)i * lda + j] = a[(size_t)j * lda + i];
+                a[(size_t)j * lda + i] = tmp;
+            }
+        }
+        for(int jb = ib + rb; jb < n; jb += MATRIX_TRANSPOSE_BLOCK){
+            int cb = n - jb < MATRIX_TRANSPOSE_BLOCK ? n - jb : MATRIX_TRANSPOSE_BLOCK;
+            swap(rb, cb, a + (size_t)ib * lda + jb, a + (size_t)jb * lda + ib, lda);
+        }
+    }
+}
+
+/*
+    Unblocked LU factorization with partial pivoting of the panel made of
+    columns j..j+nb-1 (rows j..n-1) of an n x n matrix. Whole rows are
+    swapped, so every interchange is applied to the entire matrix.
+    Returns 0, or index + 1 of the first exactly zero pivot.
+*/
+static int luFactorPanel(int n, int j, int nb, double* a, int lda, int* pivots){
+    int info = 0;
+    for(int kk = j; kk < j + nb; kk++){
+        // Choose the row with the largest magnitude in column kk as pivot
+        int p = kk;
+        double best = fabs(a[(size_t)kk * lda + kk]);
+        for(int i = kk + 1; i < n; i++){
+            double v = fabs(a[(size_t)i * lda + kk]);
+            if(v > best){
+                best = v;
+                p = i;
+            }
+        }
+        pivots[kk] = p;
+        double* rowK = a + (size_t)kk * lda;
+        if(p != kk){
+            double* rowP = a + (size_t)p * lda;
+            for(int c = 0; c < n; c++){
+                double tmp = rowK[c];
+                rowK[c] = rowP[c];
+                rowP[c] = tmp;
+            }
+        }
+        // A zero pivot means the whole column below is zero, nothing to eliminate
+        if(rowK[kk] == 0.0){
+            if(info == 0){
+                info = kk + 1;
+            }
+            continue;
+        }
+        // Store the multipliers of L and update the rest of the panel
+        for(int i = kk + 1; i < n; i++){
+            double* rowI = a + (size_t)i * lda;
+            double l = rowI[kk] / rowK[kk];
+            rowI[kk] = l;
+            for(int c = kk + 1; c < j + nb; c++){
+                rowI[c] -= l * rowK[c];
+            }
+        }
+    }
+    return info;
+}
+
+/*
+    Blocked right-looking LU factorization with partial pivoting of an
+    n x n matrix stored in a, overwritten by L (unit lower, below the
+    diagonal) and U. After each panel the block row of U is obtained by
+    forward substitution and the trailing matrix is updated with one GEMM.
+    Returns 0, or index + 1 of the first exactly zero pivot.
+*/
+static int luFactor(int n, double* a, int lda, int* pivots){
+    int info = 0;
+    for(int j = 0; j < n; j += MATRIX_LU_BLOCK){
+        int nb = n - j < MATRIX_LU_BLOCK ? n - j : MATRIX_LU_BLOCK;
+        int panelInfo = luFactorPanel(n, j, nb, a, lda, pivots);
+        if(info == 0){
+            info = panelInfo;
+        }
+        int rest = n - j - nb;
+        if(rest == 0){
+            continue;
+        }
+        // U12 = L11^-1 * A12, row by row so the accesses stay sequential
+        for(int r = j + 1; r < j + nb; r++){
+            double* rowR = a + (size_t)r * lda;
+            for(int q = j; q < r; q++){
+                double l = rowR[q];
+                const double* rowQ = a + (size_t)q * lda;
+                for(int c = j + nb; c < n; c++){
+                    rowR[c] -= l * rowQ[c];
+                }
+            }
+        }
+        // A22 = A22 - L21 * U12
+        gemm(rest, rest, nb, -1.0, a + (size_t)(j + nb) * lda + j, lda, a + (size_t)j * lda + j + nb, lda,
+             1.0, a + (size_t)(j + nb) * lda + j + nb, lda);
+    }
+    return info;
+}
+
 double matrixGetValue(matrix* m, int i, int j){
     // Check if matrix exists (is not null)
     if(m == NULL){
@@ -53,7 +884,12 @@ void matrixSetValue(matrix* m, int i, int j, double value){
     return;
 }
 
-matrix* matrixCreate(int rows, int cols){
+matrix* matrixCreateWith(int rows, int cols, int flags){
+    // Check if dimensions are positive
+    if(rows < 0 || cols < 0){
+        fprintf(stderr, "Matrix dimensions could not be negative.\n");
+        return NULL;
+    }
     // Allocate memory for new matrix
     matrix* m = malloc(sizeof(matrix));
     // Check if allocation was successfull
@@ -62,30 +898,111 @@ matrix* matrixCreate(int rows, int cols){
     }
     m->rows = rows;
     m->cols = cols;
-    // Allocate memory for data array
-    m->data = malloc(sizeof(double) * rows * cols);
+    m->stride = cols;
+    m->ownsData = 1;
+    if(flags & MATRIX_CREATE_ALIGNED){
+        // Pad every row to whole cache lines; a stride of a multiple of 4 KiB
+        // would map the same column of all rows to one cache set, so add a line.
+        const int line = MATRIX_ALIGNMENT / sizeof(double);
+        m->stride = (cols + line - 1) / line * line;
+        if(m->stride > 0 && m->stride % (4096 / sizeof(double)) == 0){
+            m->stride += line;
+        }
+        // aligned_alloc requires the size to be a nonzero multiple of the alignment
+        size_t bytes = (size_t)rows * m->stride * sizeof(double);
+        m->data = aligned_alloc(MATRIX_ALIGNMENT, bytes > 0 ? bytes : MATRIX_ALIGNMENT);
+        if(m->data == NULL){
+            allocationFailure();
+        }
+        if(!(flags & MATRIX_CREATE_UNINITIALIZED)){
+            memset(m->data, 0, bytes);
+        }
+        return m;
+    }
+    // Allocate memory for data array, filled with zeros unless asked otherwise.
+    // calloc gets large blocks as fresh zero pages, so it is not slower than malloc.
+    if(flags & MATRIX_CREATE_UNINITIALIZED){
+        m->data = malloc((size_t)rows * cols * sizeof(double));
+    }
+    else{
+        m->data = calloc((size_t)rows * cols, sizeof(double));
+    }
     // Check if allocation was successfull
-    if((m->data) == NULL){
+    if((m->data) == NULL && (size_t)rows * cols > 0){
         allocationFailure();
     }
-    // Fill matrix with zeros
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(m, i, j, 0.0);
-        }
-    }
     // Return pointer to a new matrix
     return m;
 }
 
+matrix* matrixCreate(int rows, int cols){
+    return matrixCreateWith(rows, cols, MATRIX_CREATE_DEFAULT);
+}
+
 void matrixDelete(matrix* m){
-    // Free the matrix if it exists (non-null pointer).
+    // Free the matrix if it exists (non-null pointer), and its data array unless it is a view.
     if(m != NULL){
+        if(m->ownsData){
+            free(m->data);
+        }
         free(m);
     }
     return;
 }
 
+matrix* matrixViewInit(matrix* view, matrix* m, int row, int col, int rows, int cols){
+    // Check if matrices exist (are not null)
+    if(view == NULL || m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check if the block lies inside the parent matrix
+    if(row < 0 || col < 0 || rows < 0 || cols < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return NULL;
+    }
+    if(row > m->rows - rows || col > m->cols - cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return NULL;
+    }
+    // The view keeps the row stride of its parent and points at the first element of the block
+    view->rows = rows;
+    view->cols = cols;
+    view->stride = m->stride;
+    view->ownsData = 0;
+    view->data = m->data + MATRIX_ADDR(m, row, col);
+    return view;
+}
+
+matrix* matrixView(matrix* m, int row, int col, int rows, int cols){
+    // Allocate memory for the view header
+    matrix* view = malloc(sizeof(matrix));
+    // Check if allocation was successfull
+    if(view == NULL){
+        allocationFailure();
+    }
+    if(matrixViewInit(view, m, row, col, rows, cols) == NULL){
+        free(view);
+        return NULL;
+    }
+    // Return pointer to a new view
+    return view;
+}
+
+int matrixOverlaps(matrix* m1, matrix* m2){
+    if(m1 == NULL || m2 == NULL){
+        return 0;
+    }
+    // Empty matrices do not own any elements
+    if(m1->rows == 0 || m1->cols == 0 || m2->rows == 0 || m2->cols == 0){
+        return 0;
+    }
+    // Compare the address ranges from the first to one past the last element
+    const double* end1 = m1->data + MATRIX_ADDR(m1, m1->rows - 1, m1->cols);
+    const double* end2 = m2->data + MATRIX_ADDR(m2, m2->rows - 1, m2->cols);
+    return m1->data < end2 && m2->data < end1;
+}
+
 void matrixPrint(matrix* m){
     // Check if matrix exists (is not null)
     if(m == NULL){
@@ -103,11 +1020,76 @@ void matrixPrint(matrix* m){
     }
 }
 
-matrix* matrixMul(matrix* m1, matrix* m2){
-    int rows = m1->rows;
-    int cols = m2->cols;
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+/*
+    Static helper checking that dst has the given dimensions.
+    Prints an error message and returns 0 if it does not.
+*/
+static int checkDestination(matrix* dst, int rows, int cols){
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return 0;
+    }
+    if(dst->rows != rows || dst->cols != cols){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Static helper checking that dst is either exactly the operand m
+    (same elements and layout, so element-wise results may be written
+    in place) or does not share memory with it.
+    Prints an error message and returns 0 otherwise.
+*/
+static int checkElementwiseAlias(matrix* dst, matrix* m){
+    if(matrixOverlaps(dst, m) && (dst->data != m->data || dst->stride != m->stride)){
+        fprintf(stderr, "Destination partially overlaps an operand.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Static helper returning 1 if the rows of m follow each other
+    without gaps, so its elements can be processed as one array.
+*/
+static int isContiguous(matrix* m){
+    return m->stride == m->cols || m->rows <= 1;
+}
+
+/*
+    Apply a binary element-wise kernel to whole matrices, as a single
+    array when all of them are contiguous and row by row otherwise.
+*/
+static void elementwiseApplyBinary(elementwiseBinaryFn fn, matrix* dst, matrix* m1, matrix* m2){
+    if(isContiguous(dst) && isContiguous(m1) && isContiguous(m2)){
+        fn((size_t)dst->rows * dst->cols, m1->data, m2->data, dst->data);
+        return;
+    }
+    for(int i = 0; i < dst->rows; i++){
+        fn(dst->cols, m1->data + MATRIX_ADDR(m1, i, 0), m2->data + MATRIX_ADDR(m2, i, 0), dst->data + MATRIX_ADDR(dst, i, 0));
+    }
+}
+
+/*
+    Apply a scalar element-wise kernel to whole matrices, as a single
+    array when both of them are contiguous and row by row otherwise.
+*/
+static void elementwiseApplyScalar(elementwiseScalarFn fn, matrix* dst, matrix* m1, double value){
+    if(isContiguous(dst) && isContiguous(m1)){
+        fn((size_t)dst->rows * dst->cols, m1->data, value, dst->data);
+        return;
+    }
+    for(int i = 0; i < dst->rows; i++){
+        fn(dst->cols, m1->data + MATRIX_ADDR(m1, i, 0), value, dst->data + MATRIX_ADDR(dst, i, 0));
+    }
+}
+
+matrix* matrixMulWith(matrix* dst, matrix* m1, matrix* m2, matrixMulAlgorithm algorithm, matrixMulAlgorithm* used){
+    static _Thread_local double* work = NULL;
+    static _Thread_local size_t workCapacity = 0;
+
     // Check if matrices exist (are not null)
     if(m1 == NULL || m2 == NULL){
         fprintf(stderr, "At least one of the matrices isn't allocated.\n");
@@ -118,88 +1100,170 @@ matrix* matrixMul(matrix* m1, matrix* m2){
         fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
         return NULL;
     }
-    // For each position (i, j) in the result matrix, calculate the sum
-    // of element-wise products of row i from m1 and column j from m2.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            double sum = 0.0;
-            for (int k=0; k < m1->cols; k++) {
-                sum += matrixGetValue(m1, i, k) * matrixGetValue(m2, k, j);
+    if(!checkDestination(dst, m1->rows, m2->cols)){
+        return NULL;
+    }
+    // The product reads m1 and m2 while writing dst, so they cannot share memory.
+    if(matrixOverlaps(dst, m1) || matrixOverlaps(dst, m2)){
+        fprintf(stderr, "Destination of a matrix product cannot be one of its operands.\n");
+        return NULL;
+    }
+    int m = m1->rows, n = m2->cols, k = m1->cols;
+    // Automatic choice: small products use a simple loop, larger ones the cache-blocked kernel.
+    if(algorithm == MATRIX_MUL_AUTO){
+        algorithm = k == 0 || (long long)m * n * k < MATRIX_GEMM_THRESHOLD ? MATRIX_MUL_SIMPLE : MATRIX_MUL_BLOCKED;
+    }
+    switch(algorithm){
+        case MATRIX_MUL_SIMPLE:
+            gemmSimple(m, n, k, 1.0, m1->data, m1->stride, m2->data, m2->stride, 0.0, dst->data, dst->stride);
+            break;
+        case MATRIX_MUL_STRASSEN:
+            // The workspace for all recursion levels is reserved once and kept for later calls
+            workspaceReserve(&work, &workCapacity, strassenWorkspace(m, n, k));
+            if(strassenRecursive(m, n, k, m1->data, m1->stride, m2->data, m2->stride, dst->data, dst->stride, work) > 0){
+                break;
             }
-            result->data[MATRIX_ADDR(result,i,j)] = sum;
-        }
+            // Too small for a single level: the classical kernel was used
+            algorithm = k == 0 || (long long)m * n * k < MATRIX_GEMM_THRESHOLD ? MATRIX_MUL_SIMPLE : MATRIX_MUL_BLOCKED;
+            break;
+        default:
+            algorithm = MATRIX_MUL_BLOCKED;
+            gemmBlocked(m, n, k, 1.0, m1->data, m1->stride, m2->data, m2->stride, 0.0, dst->data, dst->stride, gemmThreads(m, n, k));
+            break;
+    }
+    // Report the algorithm that computed the product
+    if(used != NULL){
+        *used = algorithm;
+    }
+    return dst;
+}
+
+matrix* matrixMulInto(matrix* dst, matrix* m1, matrix* m2){
+    // Each element (i, j) is the dot product of row i from m1 and column j from m2.
+    return matrixMulWith(dst, m1, m2, MATRIX_MUL_AUTO, NULL);
+}
+
+void matrixSetStrassenCutover(int size){
+    strassenCutover = size > 0 ? size : MATRIX_STRASSEN_CUTOVER;
+}
+
+int matrixGetStrassenCutover(){
+    return strassenCutover;
+}
+
+matrix* matrixMul(matrix* m1, matrix* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
     }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m2->cols, MATRIX_CREATE_UNINITIALIZED);
+
+    // Compute the product into the new matrix.
+    matrixMulInto(result, m1, m2);
+
     // Return pointer to a new matrix
     return result;
 }
 
-matrix* matrixMulScalar(matrix* m1, double value){
+matrix* matrixMulScalarInto(matrix* dst, matrix* m1, double value){
     // Check if matrix exists (is not null)
     if(m1 == NULL){
         fprintf(stderr, "Matrix does not exist.\n");
         return NULL;
     }
-    int rows = m1->rows;
-    int cols = m1->cols;
+    if(!checkDestination(dst, m1->rows, m1->cols) || !checkElementwiseAlias(dst, m1)){
+        return NULL;
+    }
+    // Multiply every element of the original matrix by the scalar.
+    elementwiseApplyScalar(matrixElementwiseKernels()->mulScalar, dst, m1, value);
+    return dst;
+}
 
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+matrix* matrixMulScalar(matrix* m1, double value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
 
     // Fill the new matrix with values from the original matrix, each multiplied by the scalar.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(result, i, j, matrixGetValue(m1, i, j) * value);
-        }
-    }
+    matrixMulScalarInto(result, m1, value);
+
     // Return pointer to a new matrix
     return result;
 }
 
-matrix* matrixAddScalar(matrix* m1, double value){
+matrix* matrixAddScalarInto(matrix* dst, matrix* m1, double value){
     // Check if matrix exists (is not null)
     if(m1 == NULL){
         fprintf(stderr, "Matrix does not exist.\n");
         return NULL;
     }
-    int rows = m1->rows;
-    int cols = m1->cols;
+    if(!checkDestination(dst, m1->rows, m1->cols) || !checkElementwiseAlias(dst, m1)){
+        return NULL;
+    }
+    // Increase every element of the original matrix by the scalar.
+    elementwiseApplyScalar(matrixElementwiseKernels()->addScalar, dst, m1, value);
+    return dst;
+}
 
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+matrix* matrixAddScalar(matrix* m1, double value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
 
     // Fill the new matrix with values from the original matrix, each increased by the scalar.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(result, i, j, matrixGetValue(m1, i, j) + value);
-        }
-    }
+    matrixAddScalarInto(result, m1, value);
+
     // Return pointer to a new matrix
     return result;
 }
 
-matrix* matrixSubScalar(matrix* m1, double value){
+matrix* matrixSubScalarInto(matrix* dst, matrix* m1, double value){
     // Check if matrix exists (is not null)
     if(m1 == NULL){
         fprintf(stderr, "Matrix does not exist.\n");
         return NULL;
     }
-    int rows = m1->rows;
-    int cols = m1->cols;
+    if(!checkDestination(dst, m1->rows, m1->cols) || !checkElementwiseAlias(dst, m1)){
+        return NULL;
+    }
+    // Decrease every element of the original matrix by the scalar.
+    // Adding -value gives exactly the same result as subtracting value.
+    elementwiseApplyScalar(matrixElementwiseKernels()->addScalar, dst, m1, -value);
+    return dst;
+}
 
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+matrix* matrixSubScalar(matrix* m1, double value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
 
     // Fill the new matrix with values from the original matrix, each decreased by the scalar.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(result, i, j, matrixGetValue(m1, i, j) - value);
-        }
-    }
+    matrixSubScalarInto(result, m1, value);
+
     // Return pointer to a new matrix
     return result;
 }
 
-matrix* matrixAdd(matrix* m1, matrix* m2){
+matrix* matrixAddInto(matrix* dst, matrix* m1, matrix* m2){
     // Check if matrices exist (are not null)
     if(m1 == NULL || m2 == NULL){
         fprintf(stderr, "At least one of the matrices isn't allocated.\n");
@@ -210,22 +1274,54 @@ matrix* matrixAdd(matrix* m1, matrix* m2){
         fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
         return NULL;
     }
-    int rows = m1->rows;
-    int cols = m1->cols;
+    if(!checkDestination(dst, m1->rows, m1->cols) || !checkElementwiseAlias(dst, m1) || !checkElementwiseAlias(dst, m2)){
+        return NULL;
+    }
+    // Store the sum of corresponding elements from m1 and m2.
+    elementwiseApplyBinary(matrixElementwiseKernels()->add, dst, m1, m2);
+    return dst;
+}
 
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+matrix* matrixAdd(matrix* m1, matrix* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->cols || m1->rows != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
 
     // Fill the new matrix with the sum of corresponding elements from m1 and m2.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(result, i, j, matrixGetValue(m1, i, j) + matrixGetValue(m2, i, j));
-        }
-    }
+    matrixAddInto(result, m1, m2);
+
     // Return pointer to a new matrix
     return result;
 }
 
+matrix* matrixSubInto(matrix* dst, matrix* m1, matrix* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->cols || m1->rows != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, m1->rows, m1->cols) || !checkElementwiseAlias(dst, m1) || !checkElementwiseAlias(dst, m2)){
+        return NULL;
+    }
+    // Store the difference of corresponding elements from m1 and m2.
+    elementwiseApplyBinary(matrixElementwiseKernels()->sub, dst, m1, m2);
+    return dst;
+}
+
 matrix* matrixSub(matrix* m1, matrix* m2){
     // Check if matrices exist (are not null)
     if(m1 == NULL || m2 == NULL){
@@ -238,38 +1334,170 @@ matrix* matrixSub(matrix* m1, matrix* m2){
         fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
         return NULL;
     }
-    int rows = m1->rows;
-    int cols = m1->cols;
-
-    // Create a new matrix instance using the matrixCreate function.
-    matrix* result = matrixCreate(rows, cols);
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
 
     // Fill the new matrix with the difference of corresponding elements from m1 and m2.
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            matrixSetValue(result, i, j, matrixGetValue(m1, i, j) - matrixGetValue(m2, i, j));
-        }
-    }
+    matrixSubInto(result, m1, m2);
+
     // Return pointer to a new matrix
     return result;
 }
 
-matrix* matrixTranspose(matrix* m){
+matrix* matrixTransposeInto(matrix* dst, matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, m->cols, m->rows)){
+        return NULL;
+    }
+    // Every element is read from another position, so the operand cannot be overwritten.
+    if(matrixOverlaps(dst, m)){
+        fprintf(stderr, "Destination of a transpose cannot be its operand.\n");
+        return NULL;
+    }
+    // Copy element (i, j) of the original matrix to (j, i), tile by tile.
+    transposeBlocked(m->rows, m->cols, m->data, m->stride, dst->data, dst->stride);
+    return dst;
+}
 
-    // Create a new matrix using matrixCreate with rows and columns swapped.
-    matrix* matrixT = matrixCreate(m->cols, m->rows);
+matrix* matrixTransposeInPlace(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Only a square matrix keeps its shape when transposed
+    if(m->rows != m->cols){
+        fprintf(stderr, "Cannot transpose a non-square matrix in place.\n");
+        return NULL;
+    }
+    transposeSquareInPlace(m->rows, m->data, m->stride);
+    return m;
+}
 
-    // Set the value at (j, i) in the transposed matrix from the original matrix.
-    for(int i = 0; i < matrixT->rows; i++){
-        for(int j = 0; j < matrixT->cols; j++){
-            matrixSetValue(matrixT, i, j, matrixGetValue(m, j, i));
-        }
+matrix* matrixTranspose(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
     }
 
+    // Create a new matrix with rows and columns swapped; every element is written below, so it is not zeroed.
+    matrix* matrixT = matrixCreateWith(m->cols, m->rows, MATRIX_CREATE_UNINITIALIZED);
+
+    // Fill the transposed matrix from the original matrix.
+    matrixTransposeInto(matrixT, m);
+
     // Return pointer to a new matrix
     return matrixT;
 }
 
+/*
+    Static helper copying the elements of src into dst of the same dimensions.
+*/
+static void copyElements(matrix* dst, matrix* src){
+    for(int i = 0; i < src->rows; i++){
+        memcpy(dst->data + MATRIX_ADDR(dst, i, 0), src->data + MATRIX_ADDR(src, i, 0), sizeof(double) * src->cols);
+    }
+}
+
+/*
+    Return the one of the three buffers that is neither `a` nor `b`.
+*/
+static matrix* powSpare(matrix* buffers[3], matrix* a, matrix* b){
+    for(int i = 0; i < 3; i++){
+        if(buffers[i] != a && buffers[i] != b){
+            return buffers[i];
+        }
+    }
+    return NULL;
+}
+
+matrix* matrixPowInto(matrix* dst, matrix* m, long long k){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check if matrix is square
+    if(m->rows != m->cols){
+        fprintf(stderr, "Cannot raise a non-square matrix to a power.\n");
+        return NULL;
+    }
+    if(k < 0){
+        fprintf(stderr, "Exponent could not be negative.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, m->rows, m->cols)){
+        return NULL;
+    }
+    int n = m->rows;
+    if(k == 0){
+        for(int i = 0; i < n; i++){
+            double* row = dst->data + MATRIX_ADDR(dst, i, 0);
+            memset(row, 0, sizeof(double) * n);
+            row[i] = 1.0;
+        }
+        return dst;
+    }
+    // m is copied first, so dst may share memory with it. Every product
+    // is written into the buffer that holds neither operand.
+    matrix* buffers[3] = {dst, matrixCreateWith(n, n, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED),
+                          matrixCreateWith(n, n, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED)};
+    matrix* base = buffers[1];
+    matrix* result = NULL;
+    copyElements(base, m);
+    for(;;){
+        // result = result * m^(2^i) for every set bit i of k; the first factor is used as it is
+        if(k & 1){
+            if(result == NULL){
+                result = base;
+            }
+            else{
+                matrix* product = powSpare(buffers, result, base);
+                matrixMulInto(product, result, base);
+                result = product;
+            }
+        }
+        k >>= 1;
+        if(k == 0){
+            break;
+        }
+        matrix* square = powSpare(buffers, base, result);
+        matrixMulInto(square, base, base);
+        base = square;
+    }
+    if(result != dst){
+        copyElements(dst, result);
+    }
+    matrixDelete(buffers[1]);
+    matrixDelete(buffers[2]);
+    return dst;
+}
+
+matrix* matrixPow(matrix* m, long long k){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check the arguments before allocating
+    if(m->rows != m->cols){
+        fprintf(stderr, "Cannot raise a non-square matrix to a power.\n");
+        return NULL;
+    }
+    if(k < 0){
+        fprintf(stderr, "Exponent could not be negative.\n");
+        return NULL;
+    }
+    matrix* result = matrixCreateWith(m->rows, m->cols, MATRIX_CREATE_UNINITIALIZED);
+    matrixPowInto(result, m, k);
+    return result;
+}
+
 double matrixDetChio(matrix* m){
     // Check if matrix exists (is not null)
     if(m == NULL){
@@ -315,8 +1543,11 @@ double matrixDetChio(matrix* m){
         return -1;
     }
 
-    // Create a (n-1)x(n-1) matrix for recursive calculation in Chio's method
-    matrix* mTmp = matrixCreate(m->rows-1, m->cols-1);
+    // Create a (n-1)x(n-1) matrix for recursive calculation in Chio's method.
+    // It lives in the scratch arena, so the whole recursion allocates nothing once warmed up.
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    matrix* mTmp = matrixArenaMatrix(arena, m->rows-1, m->cols-1, MATRIX_CREATE_UNINITIALIZED);
 
     // Adjust coefficient c according to Chio's formula
     c = c/pow(matrixGetValue(m, 0, 0), m->cols-2);
@@ -330,9 +1561,64 @@ double matrixDetChio(matrix* m){
     // Recursively calculate determinant of the smaller matrix and apply coefficient c
     double result = c * matrixDetChio(mTmp);
 
-    // Free memory of temporary matrix
-    matrixDelete(mTmp);
+    // Release the temporary matrix (and those of the recursive calls)
+    matrixArenaRelease(arena, mark);
 
     // Return the computed determinant (double)
     return result;
-}
\ No newline at end of file
+}
+
+int matrixLU(matrix* m, int* pivots){
+    // Check if matrix and pivot array exist (are not null)
+    if(m == NULL || pivots == NULL){
+        fprintf(stderr, "Matrix or pivot array does not exist.\n");
+        return -1;
+    }
+    // Check if matrix is square
+    if(m->cols != m->rows){
+        fprintf(stderr, "Cannot compute LU decomposition of a non-square matrix.\n");
+        return -1;
+    }
+    // Factorize in place
+    return luFactor(m->rows, m->data, m->stride, pivots);
+}
+
+double matrixDet(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NAN;
+    }
+    // Check if matrix is square
+    if(m->cols != m->rows){
+        fprintf(stderr, "Cannot compute determinant of a non-square matrix.\n");
+        return NAN;
+    }
+    int n = m->rows;
+    // The determinant of an empty matrix is 1
+    if(n == 0){
+        return 1.0;
+    }
+    // One scratch buffer holds the copy being factorized followed by the pivot indices
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    double* scratch = matrixArenaAlloc(arena, sizeof(double) * n * n + sizeof(int) * n);
+    int* pivots = (int*)(scratch + (size_t)n * n);
+    for(int i = 0; i < n; i++){
+        memcpy(scratch + (size_t)i * n, m->data + MATRIX_ADDR(m, i, 0), sizeof(double) * n);
+    }
+    luFactor(n, scratch, n, pivots);
+
+    // det(A) is the product of the diagonal of U, negated for every row swap
+    double det = 1.0;
+    for(int i = 0; i < n; i++){
+        det *= scratch[(size_t)i * n + i];
+        if(pivots[i] != i){
+            det = -det;
+        }
+    }
+
+    // Release the scratch buffer
+    matrixArenaRelease(arena, mark);
+    return det;
+}
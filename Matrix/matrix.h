@@ -6,19 +6,50 @@
  *
  * Given a matrix pointer `m`, row index `i`, and column index `j`,
  * this macro returns the corresponding 1D index in the `data` array
- * stored in row-major order.
+ * stored in row-major order with `stride` elements per row.
  */
-#define MATRIX_ADDR(m, i, j) ((i) * ((m)->cols) + (j))
+#define MATRIX_ADDR(m, i, j) ((size_t)(i) * ((m)->stride) + (j))
 
 /**
  * Structure representing a dynamic matrix stored in row-major order.
+ * A matrix either owns its data array or is a view into the data of
+ * another matrix; views share memory with their parent and are never
+ * copied. Every operation accepts both.
  */
 typedef struct {
     int rows;       /** Number of rows in the matrix */
     int cols;       /** Number of columns in the matrix */
-    double* data;   /** Pointer to the matrix elements */
+    double* data;   /** Pointer to the first matrix element */
+    int stride;     /** Number of elements between the starts of consecutive rows (>= cols) */
+    int ownsData;   /** Nonzero if `data` is freed together with the matrix */
 } matrix;
 
+/**
+ * Alignment in bytes of the data of matrices created with MATRIX_CREATE_ALIGNED.
+ * Rows of such matrices are padded to a multiple of this size.
+ */
+#define MATRIX_ALIGNMENT 64
+
+/**
+ * Flags controlling how matrixCreateWith allocates the data array.
+ * Flags may be combined with `|`.
+ */
+typedef enum {
+    MATRIX_CREATE_DEFAULT = 0,          /** Zero-filled rows packed back to back */
+    MATRIX_CREATE_ALIGNED = 1,          /** MATRIX_ALIGNMENT-aligned data, every row padded to a multiple of it */
+    MATRIX_CREATE_UNINITIALIZED = 2     /** Leave the elements uninitialized */
+} matrixCreateFlags;
+
+/**
+ * Algorithms available for matrix multiplication.
+ */
+typedef enum {
+    MATRIX_MUL_AUTO,        /** Choose SIMPLE or BLOCKED from the size of the product */
+    MATRIX_MUL_SIMPLE,      /** Simple loop over the data arrays */
+    MATRIX_MUL_BLOCKED,     /** Cache-blocked packed kernel, multithreaded for large products */
+    MATRIX_MUL_STRASSEN     /** Strassen-Winograd recursion down to the cutover size */
+} matrixMulAlgorithm;
+
 /**
  * Get the value at position (i, j) in the matrix.
  * @param m Pointer to the matrix
@@ -38,7 +69,7 @@ double matrixGetValue(matrix* m, int i, int j);
 void matrixSetValue(matrix* m, int i, int j, double value);
 
 /**
- * Create a new matrix with given dimensions.
+ * Create a new matrix with given dimensions, filled with zeros.
  * Function allocates memory for the matrix automatically.
  * @param rows Number of rows
  * @param cols Number of columns
@@ -47,11 +78,63 @@ void matrixSetValue(matrix* m, int i, int j, double value);
 matrix* matrixCreate(int rows, int cols);
 
 /**
- * Free the memory associated with the matrix.
+ * Create a new matrix with given dimensions and allocation flags.
+ * With MATRIX_CREATE_ALIGNED the row stride is rounded up to a whole number
+ * of cache lines (plus one more when it would be a multiple of 4 KiB, to avoid
+ * cache-set conflicts), so every row starts on a MATRIX_ALIGNMENT boundary.
+ * With MATRIX_CREATE_UNINITIALIZED the elements must be written before they are read.
+ * Function allocates memory for the matrix automatically.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param flags Combination of matrixCreateFlags
+ * @return Pointer to the newly created matrix, or NULL if dimensions are negative
+ */
+matrix* matrixCreateWith(int rows, int cols, int flags);
+
+/**
+ * Free the memory associated with the matrix and its data array.
  * @param m Pointer to the matrix to delete
  */
 void matrixDelete(matrix* m);
 
+/**
+ * Create a view of the rows × cols block of m starting at (row, col).
+ * No elements are copied: the view shares memory with m, so writes through
+ * either are visible in both. A single row or column is a block with one
+ * row or one column. m must outlive the view.
+ * Function allocates memory for the view header only; free it with matrixDelete,
+ * which leaves the elements of m untouched.
+ * @param m Pointer to the parent matrix (may itself be a view)
+ * @param row First row of the block
+ * @param col First column of the block
+ * @param rows Number of rows of the block
+ * @param cols Number of columns of the block
+ * @return Pointer to the newly created view, or NULL if the block does not fit in m
+ */
+matrix* matrixView(matrix* m, int row, int col, int rows, int cols);
+
+/**
+ * Initialize a caller-provided matrix as a view of the rows × cols block
+ * of m starting at (row, col), without allocating any memory.
+ * The view must not be passed to matrixDelete.
+ * @param view Pointer to the matrix structure to fill
+ * @param m Pointer to the parent matrix (may itself be a view)
+ * @param row First row of the block
+ * @param col First column of the block
+ * @param rows Number of rows of the block
+ * @param cols Number of columns of the block
+ * @return view, or NULL if the block does not fit in m
+ */
+matrix* matrixViewInit(matrix* view, matrix* m, int row, int col, int rows, int cols);
+
+/**
+ * Check whether two matrices (or views) may share elements.
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return 1 if the memory ranges of the matrices overlap, 0 otherwise
+ */
+int matrixOverlaps(matrix* m1, matrix* m2);
+
 /**
  * Print the matrix to stdout.
  * @param m Pointer to the matrix to print
@@ -67,6 +150,45 @@ void matrixPrint(matrix* m);
  */
 matrix* matrixMul(matrix* m1, matrix* m2);
 
+/**
+ * Multiply two matrices (m1 × m2) into an existing matrix.
+ * No memory is allocated; dst must not overlap the operands.
+ * @param dst Pointer to the destination matrix (m1->rows × m2->cols)
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions are invalid
+ */
+matrix* matrixMulInto(matrix* dst, matrix* m1, matrix* m2);
+
+/**
+ * Multiply two matrices (m1 × m2) into an existing matrix with a chosen algorithm.
+ * MATRIX_MUL_STRASSEN recurses while all dimensions exceed the Strassen cutover;
+ * its workspace is allocated once per thread and reused by later calls.
+ * Strassen-Winograd trades some accuracy for fewer multiplications.
+ * @param dst Pointer to the destination matrix (m1->rows × m2->cols)
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @param algorithm Algorithm to use
+ * @param used If not NULL, receives the algorithm that actually computed the product
+ *             (STRASSEN falls back to a classical kernel below the cutover)
+ * @return dst, or NULL if dimensions are invalid
+ */
+matrix* matrixMulWith(matrix* dst, matrix* m1, matrix* m2, matrixMulAlgorithm algorithm, matrixMulAlgorithm* used);
+
+/**
+ * Set the size at or below which the Strassen-Winograd recursion switches
+ * to the classical kernel.
+ * @param size Cutover size, or 0 to restore the default (MATRIX_STRASSEN_CUTOVER)
+ */
+void matrixSetStrassenCutover(int size);
+
+/**
+ * Get the size at or below which the Strassen-Winograd recursion switches
+ * to the classical kernel.
+ * @return Cutover size
+ */
+int matrixGetStrassenCutover();
+
 /**
  * Add two matrices (m1 + m2).
  * Function allocates memory for the matrix automatically.
@@ -76,6 +198,17 @@ matrix* matrixMul(matrix* m1, matrix* m2);
  */
 matrix* matrixAdd(matrix* m1, matrix* m2);
 
+/**
+ * Add two matrices (m1 + m2) into an existing matrix.
+ * No memory is allocated; dst may be m1 or m2 to add in place,
+ * but must not partially overlap them.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixAddInto(matrix* dst, matrix* m1, matrix* m2);
+
 /**
  * Multiply all elements of a matrix by a scalar value.
  * Function allocates memory for the matrix automatically.
@@ -85,6 +218,17 @@ matrix* matrixAdd(matrix* m1, matrix* m2);
  */
 matrix* matrixMulScalar(matrix* m1, double value);
 
+/**
+ * Multiply all elements of a matrix by a scalar value into an existing matrix.
+ * No memory is allocated; dst may be m1 to scale in place,
+ * but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to multiply
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixMulScalarInto(matrix* dst, matrix* m1, double value);
+
 /**
  * Add a scalar value to all elements of the matrix.
  * Function allocates memory for the matrix automatically.
@@ -94,6 +238,17 @@ matrix* matrixMulScalar(matrix* m1, double value);
  */
 matrix* matrixAddScalar(matrix* m1, double value);
 
+/**
+ * Add a scalar value to all elements of the matrix into an existing matrix.
+ * No memory is allocated; dst may be m1 to add in place,
+ * but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to add
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixAddScalarInto(matrix* dst, matrix* m1, double value);
+
 /**
  * Subtract a scalar value from all elements of the matrix.
  * Function allocates memory for the matrix automatically.
@@ -103,6 +258,17 @@ matrix* matrixAddScalar(matrix* m1, double value);
  */
 matrix* matrixSubScalar(matrix* m1, double value);
 
+/**
+ * Subtract a scalar value from all elements of the matrix into an existing matrix.
+ * No memory is allocated; dst may be m1 to subtract in place,
+ * but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to subtract
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixSubScalarInto(matrix* dst, matrix* m1, double value);
+
 /**
  * Subtract two matrices (m1 - m2).
  * Function allocates memory for the matrix automatically.
@@ -112,6 +278,17 @@ matrix* matrixSubScalar(matrix* m1, double value);
  */
 matrix* matrixSub(matrix* m1, matrix* m2);
 
+/**
+ * Subtract two matrices (m1 - m2) into an existing matrix.
+ * No memory is allocated; dst may be m1 or m2 to subtract in place,
+ * but must not partially overlap them.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixSubInto(matrix* dst, matrix* m1, matrix* m2);
+
 /**
  * Compute the transpose of a matrix.
  * Function allocates memory for the matrix automatically.
@@ -120,6 +297,61 @@ matrix* matrixSub(matrix* m1, matrix* m2);
  */
 matrix* matrixTranspose(matrix* m);
 
+/**
+ * Compute the transpose of a matrix into an existing matrix.
+ * No memory is allocated; dst must not overlap m.
+ * @param dst Pointer to the destination matrix (m->cols × m->rows)
+ * @param m Pointer to the matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixTransposeInto(matrix* dst, matrix* m);
+
+/**
+ * Transpose a square matrix in place, without allocating a second buffer.
+ * @param m Pointer to the square matrix
+ * @return m, or NULL if the matrix is not square
+ */
+matrix* matrixTransposeInPlace(matrix* m);
+
+/**
+ * Raise a square matrix to a non-negative integer power into an existing matrix,
+ * by repeated squaring with about 2 * log2(k) multiplications. Two work
+ * buffers are allocated once and reused, with dst as the third one.
+ * dst may be m.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the square matrix
+ * @param k Exponent (m^0 is the identity)
+ * @return dst, or NULL if the matrix is not square or k is negative
+ */
+matrix* matrixPowInto(matrix* dst, matrix* m, long long k);
+
+/**
+ * Raise a square matrix to a non-negative integer power (m^k).
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the square matrix
+ * @param k Exponent (m^0 is the identity)
+ * @return Pointer to the resulting matrix, or NULL if the matrix is not square or k is negative
+ */
+matrix* matrixPow(matrix* m, long long k);
+
+/**
+ * Set the number of threads used by parallel matrix operations.
+ * The worker pool is restarted with the new size on its next use.
+ * By default the pool uses the value of the MATRIX_NUM_THREADS
+ * environment variable, or the number of online processors.
+ * @param threads Number of threads (including the calling thread),
+ *                or 0 to restore the default
+ */
+void matrixSetNumThreads(int threads);
+
+/**
+ * Get the number of threads used by parallel matrix operations.
+ * Never waits for a running parallel operation. Inside a parallel task,
+ * where nested operations run serially, this is 1.
+ * @return Number of threads (including the calling thread)
+ */
+int matrixGetNumThreads();
+
 /**
  * Compute the determinant of a matrix using Chio's method.
  * Works only for square matrices.
@@ -130,4 +362,26 @@ matrix* matrixTranspose(matrix* m);
  */
 double matrixDetChio(matrix* m);
 
+/**
+ * Compute the LU decomposition with partial pivoting (P * A = L * U)
+ * of a square matrix in place, using a cache-blocked algorithm.
+ * On return the strictly lower part of the matrix holds L (its unit
+ * diagonal is not stored) and the upper part holds U. Row i was
+ * interchanged with row pivots[i] at step i.
+ * @param m Pointer to the square matrix, overwritten by L and U
+ * @param pivots Array of m->rows pivot indices filled by the function
+ * @return 0 on success, k > 0 if U(k-1, k-1) is exactly zero (the matrix
+ *         is singular, the factorization is still completed), -1 on error
+ */
+int matrixLU(matrix* m, int* pivots);
+
+/**
+ * Compute the determinant of a matrix using LU decomposition.
+ * Works only for square matrices. The matrix is not modified;
+ * the factorization uses a single scratch buffer.
+ * @param m Pointer to the square matrix
+ * @return Determinant of the matrix, or NAN on error
+ */
+double matrixDet(matrix* m);
+
 #endif /* MATRIX_H */
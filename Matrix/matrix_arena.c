@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+#include "matrix_arena.h"
+#include "thread_pool.h"
+
+/*
+    Capacity of arenas created with a size of 0.
+*/
+#ifndef MATRIX_ARENA_DEFAULT_SIZE
+#define MATRIX_ARENA_DEFAULT_SIZE (1024 * 1024)
+#endif
+
+/*
+    Bytes the scratch arenas keep in blocks beyond a released mark; the
+    blocks left over from larger requests are freed on release.
+*/
+#ifndef MATRIX_SCRATCH_RETAIN
+#define MATRIX_SCRATCH_RETAIN (32 * 1024 * 1024)
+#endif
+
+/*
+    The header of every block is padded, so its data starts aligned.
+*/
+#define ARENA_HEADER ((sizeof(matrixArenaBlock) + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT)
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Round a size up to a multiple of the alignment, so every allocation stays aligned.
+*/
+// Scratch arena of the calling thread, see matrixArenaScratch
+static _Thread_local matrixArena* scratch = NULL;
+
+static size_t alignSize(size_t bytes){
+    return (bytes + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+}
+
+static matrixArenaBlock* blockCreate(size_t size){
+    size = alignSize(size);
+    matrixArenaBlock* b = aligned_alloc(MATRIX_ALIGNMENT, ARENA_HEADER + size);
+    if(b == NULL){
+        allocationFailure();
+    }
+    b->next = NULL;
+    b->size = size;
+    return b;
+}
+
+static void blockDeleteAll(matrixArenaBlock* b){
+    while(b != NULL){
+        matrixArenaBlock* next = b->next;
+        free(b);
+        b = next;
+    }
+}
+
+matrixArena* matrixArenaCreate(size_t bytes){
+    matrixArena* a = malloc(sizeof(matrixArena));
+    if(a == NULL){
+        allocationFailure();
+    }
+    a->first = blockCreate(bytes > 0 ? bytes : MATRIX_ARENA_DEFAULT_SIZE);
+    a->current = a->first;
+    a->used = 0;
+    return a;
+}
+
+void matrixArenaDelete(matrixArena* a){
+    // Free the arena and its blocks if it exists (non-null pointer).
+    if(a != NULL){
+        blockDeleteAll(a->first);
+        free(a);
+    }
+    return;
+}
+
+void* matrixArenaAlloc(matrixArena* a, size_t bytes){
+    // Check if arena exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Arena does not exist.\n");
+        return NULL;
+    }
+    bytes = alignSize(bytes);
+    if(bytes > a->current->size - a->used){
+        // Continue in the next block if it is large enough, otherwise
+        // insert a new one before it; the blocks are kept for reuse either way.
+        matrixArenaBlock* next = a->current->next;
+        if(next == NULL || next->size < bytes){
+            size_t size = a->current->size * 2 > bytes ? a->current->size * 2 : bytes;
+            matrixArenaBlock* b = blockCreate(size);
+            b->next = next;
+            a->current->next = b;
+            next = b;
+        }
+        a->current = next;
+        a->used = 0;
+    }
+    void* p = (char*)a->current + ARENA_HEADER + a->used;
+    a->used += bytes;
+    return p;
+}
+
+matrix* matrixArenaMatrix(matrixArena* a, int rows, int cols, int flags){
+    // Check if arena exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Arena does not exist.\n");
+        return NULL;
+    }
+    // Check if dimensions are positive
+    if(rows < 0 || cols < 0){
+        fprintf(stderr, "Matrix dimensions could not be negative.\n");
+        return NULL;
+    }
+    matrix* m = matrixArenaAlloc(a, sizeof(matrix));
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = cols;
+    // The data belongs to the arena, not to the matrix
+    m->ownsData = 0;
+    // Arena memory is always aligned; only the row padding follows matrixCreateWith
+    if(flags & MATRIX_CREATE_ALIGNED){
+        const int line = MATRIX_ALIGNMENT / sizeof(double);
+        m->stride = (cols + line - 1) / line * line;
+        if(m->stride > 0 && m->stride % (4096 / sizeof(double)) == 0){
+            m->stride += line;
+        }
+    }
+    size_t bytes = (size_t)rows * m->stride * sizeof(double);
+    m->data = matrixArenaAlloc(a, bytes);
+    if(!(flags & MATRIX_CREATE_UNINITIALIZED)){
+        memset(m->data, 0, bytes);
+    }
+    return m;
+}
+
+matrixArenaMark matrixArenaGetMark(matrixArena* a){
+    matrixArenaMark mark = {NULL, 0};
+    // Check if arena exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Arena does not exist.\n");
+        return mark;
+    }
+    mark.block = a->current;
+    mark.used = a->used;
+    return mark;
+}
+
+void matrixArenaRelease(matrixArena* a, matrixArenaMark mark){
+    // Check if arena and mark are valid
+    if(a == NULL || mark.block == NULL){
+        fprintf(stderr, "Arena or mark does not exist.\n");
+        return;
+    }
+    a->current = mark.block;
+    a->used = mark.used;
+    // Give back the blocks of unusually large requests to the scratch arena;
+    // the blocks after the mark are not referenced by any live mark.
+    if(a == scratch){
+        size_t retained = 0;
+        for(matrixArenaBlock* b = mark.block->next; b != NULL; b = b->next){
+            retained += b->size;
+        }
+        if(retained > MATRIX_SCRATCH_RETAIN){
+            blockDeleteAll(mark.block->next);
+            mark.block->next = NULL;
+        }
+    }
+}
+
+void matrixArenaReset(matrixArena* a){
+    // Check if arena exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Arena does not exist.\n");
+        return;
+    }
+    // A chain of blocks means the arena was too small: replace it by one
+    // block of the total size, so the next iteration does not cross blocks.
+    if(a->first->next != NULL){
+        size_t total = 0;
+        for(matrixArenaBlock* b = a->first; b != NULL; b = b->next){
+            total += b->size;
+        }
+        blockDeleteAll(a->first);
+        a->first = blockCreate(total);
+    }
+    a->current = a->first;
+    a->used = 0;
+}
+
+/*
+    Thread exit handler deleting the scratch arena of the thread.
+*/
+static void scratchDelete(void* arg){
+    (void)arg;
+    matrixArenaDelete(scratch);
+    scratch = NULL;
+}
+
+matrixArena* matrixArenaScratch(){
+    // Created once per thread and deleted when the thread exits
+    if(scratch == NULL){
+        scratch = matrixArenaCreate(0);
+        matrixAtThreadExit(scratchDelete, NULL);
+    }
+    return scratch;
+}
@@ -0,0 +1,102 @@
+#ifndef MATRIX_ARENA_H
+#define MATRIX_ARENA_H
+
+#include <stddef.h>
+#include "matrix.h"
+
+/**
+ * Block of memory owned by an arena. Blocks are chained and kept
+ * across resets, so the same memory is reused by every iteration.
+ */
+typedef struct matrixArenaBlock {
+    struct matrixArenaBlock* next;  /** Next block, used once this one is full */
+    size_t size;                    /** Number of usable bytes after the header */
+} matrixArenaBlock;
+
+/**
+ * Stack (bump) allocator for short-lived matrices and buffers.
+ * Allocations are released all at once, by a reset or by going back to a mark.
+ * An arena is not thread-safe; every thread needs its own.
+ */
+typedef struct {
+    matrixArenaBlock* first;    /** First block of the chain */
+    matrixArenaBlock* current;  /** Block allocations are taken from */
+    size_t used;                /** Number of bytes used in the current block */
+} matrixArena;
+
+/**
+ * Position in an arena, obtained from matrixArenaGetMark.
+ */
+typedef struct {
+    matrixArenaBlock* block;
+    size_t used;
+} matrixArenaMark;
+
+/**
+ * Create an arena.
+ * Function allocates memory for the arena automatically; more blocks are
+ * added when it runs out of space.
+ * @param bytes Initial capacity in bytes, or 0 for a default of 1 MiB
+ * @return Pointer to the newly created arena
+ */
+matrixArena* matrixArenaCreate(size_t bytes);
+
+/**
+ * Free the arena and all of its memory. Every matrix created from it becomes invalid.
+ * @param a Pointer to the arena to delete
+ */
+void matrixArenaDelete(matrixArena* a);
+
+/**
+ * Allocate an uninitialized buffer from the arena, aligned to MATRIX_ALIGNMENT bytes.
+ * @param a Pointer to the arena
+ * @param bytes Size of the buffer
+ * @return Pointer to the buffer, or NULL if a is NULL
+ */
+void* matrixArenaAlloc(matrixArena* a, size_t bytes);
+
+/**
+ * Create a matrix whose header and data live in the arena.
+ * The matrix is freed by resetting the arena (or releasing a mark taken
+ * before it) and must not be passed to matrixDelete.
+ * @param a Pointer to the arena
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param flags Combination of matrixCreateFlags, as for matrixCreateWith
+ * @return Pointer to the new matrix, or NULL if a dimension is negative
+ */
+matrix* matrixArenaMatrix(matrixArena* a, int rows, int cols, int flags);
+
+/**
+ * Get the current position of the arena.
+ * @param a Pointer to the arena
+ * @return Mark to pass to matrixArenaRelease
+ */
+matrixArenaMark matrixArenaGetMark(matrixArena* a);
+
+/**
+ * Release everything allocated since a mark was taken, keeping the memory for reuse.
+ * Marks must be released in the reverse order they were taken.
+ * @param a Pointer to the arena
+ * @param mark Mark obtained from matrixArenaGetMark
+ */
+void matrixArenaRelease(matrixArena* a, matrixArenaMark mark);
+
+/**
+ * Release everything allocated from the arena. When the last use needed
+ * more than one block, they are merged into one large enough for it.
+ * @param a Pointer to the arena
+ */
+void matrixArenaReset(matrixArena* a);
+
+/**
+ * Return the scratch arena of the calling thread, created on first use.
+ * Functions using it take a mark on entry and release it before returning,
+ * so nested calls share the memory like a call stack. Blocks beyond
+ * MATRIX_SCRATCH_RETAIN bytes after a released mark are freed, and the
+ * arena is deleted when its thread exits.
+ * @return Pointer to the arena of the calling thread
+ */
+matrixArena* matrixArenaScratch();
+
+#endif /* MATRIX_ARENA_H */
@@ -0,0 +1,441 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "matrix.h"
+#include "matrix_batch.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Number of matrices processed at once by the batched kernels.
+    A block of every (i, j) array of the operands stays in L1/L2.
+*/
+#ifndef MATRIX_BATCH_BLOCK
+#define MATRIX_BATCH_BLOCK 256
+#endif
+
+/*
+    Batches with fewer elements than this are processed on the calling
+    thread, because waking the worker pool would cost more than it saves.
+*/
+#ifndef MATRIX_BATCH_PARALLEL_THRESHOLD
+#define MATRIX_BATCH_PARALLEL_THRESHOLD (64 * 1024)
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Static helper checking that k addresses a matrix of the batch, which may be empty.
+    Prints an error message and returns 0 if it does not.
+*/
+static int checkMatrixIndex(matrixBatch* b, int k){
+    if(b == NULL){
+        fprintf(stderr, "Batch does not exist.\n");
+        return 0;
+    }
+    if(k < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return 0;
+    }
+    if(k >= b->count){
+        fprintf(stderr, "Index out of bounds.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Static helper checking that an index addresses an element of the batch.
+    Prints an error message and returns 0 if it does not.
+*/
+static int checkIndex(matrixBatch* b, int k, int i, int j){
+    if(!checkMatrixIndex(b, k)){
+        return 0;
+    }
+    if(i < 0 || j < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return 0;
+    }
+    if(i >= b->rows || j >= b->cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Static helper checking that dst holds `count` matrices of the given dimensions.
+    Prints an error message and returns 0 if it does not.
+*/
+static int checkDestination(matrixBatch* dst, int count, int rows, int cols){
+    if(dst == NULL){
+        fprintf(stderr, "Destination batch does not exist.\n");
+        return 0;
+    }
+    if(dst->count != count || dst->rows != rows || dst->cols != cols){
+        fprintf(stderr, "Destination batch has incompatible dimensions.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Run a batched kernel over all matrices, in blocks of MATRIX_BATCH_BLOCK
+    matrices, on the worker pool when the batch is large.
+*/
+static void batchRun(matrixTaskFn fn, void* arg, int count, long long elements){
+    int blocks = (count + MATRIX_BATCH_BLOCK - 1) / MATRIX_BATCH_BLOCK;
+    if(elements < MATRIX_BATCH_PARALLEL_THRESHOLD){
+        fn(arg, 0, blocks);
+    }
+    else{
+        matrixParallelFor(blocks, 1, fn, arg);
+    }
+}
+
+matrixBatch* matrixBatchCreate(int count, int rows, int cols){
+    // Check if dimensions are positive
+    if(count < 0 || rows < 0 || cols < 0){
+        fprintf(stderr, "Batch dimensions could not be negative.\n");
+        return NULL;
+    }
+    matrixBatch* b = malloc(sizeof(matrixBatch));
+    if(b == NULL){
+        allocationFailure();
+    }
+    b->count = count;
+    b->rows = rows;
+    b->cols = cols;
+    // Pad every (i, j) array to whole cache lines, so all of them are aligned
+    const int line = MATRIX_ALIGNMENT / sizeof(double);
+    b->stride = (count + line - 1) / line * line;
+    size_t bytes = (size_t)rows * cols * b->stride * sizeof(double);
+    b->data = aligned_alloc(MATRIX_ALIGNMENT, bytes > 0 ? bytes : MATRIX_ALIGNMENT);
+    if(b->data == NULL){
+        allocationFailure();
+    }
+    // The padding is zeroed as well, so whole arrays can be processed at once
+    memset(b->data, 0, bytes);
+    return b;
+}
+
+void matrixBatchDelete(matrixBatch* b){
+    // Free the batch and its data array if it exists (non-null pointer).
+    if(b != NULL){
+        free(b->data);
+        free(b);
+    }
+    return;
+}
+
+double matrixBatchGetValue(matrixBatch* b, int k, int i, int j){
+    if(!checkIndex(b, k, i, j)){
+        return -1;
+    }
+    return b->data[MATRIX_BATCH_ADDR(b, k, i, j)];
+}
+
+void matrixBatchSetValue(matrixBatch* b, int k, int i, int j, double value){
+    if(!checkIndex(b, k, i, j)){
+        return;
+    }
+    b->data[MATRIX_BATCH_ADDR(b, k, i, j)] = value;
+}
+
+matrixBatch* matrixBatchSetMatrix(matrixBatch* b, int k, matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    if(!checkMatrixIndex(b, k)){
+        return NULL;
+    }
+    if(m->rows != b->rows || m->cols != b->cols){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    for(int i = 0; i < m->rows; i++){
+        for(int j = 0; j < m->cols; j++){
+            b->data[MATRIX_BATCH_ADDR(b, k, i, j)] = m->data[MATRIX_ADDR(m, i, j)];
+        }
+    }
+    return b;
+}
+
+matrix* matrixBatchGetMatrix(matrix* dst, matrixBatch* b, int k){
+    // Check if matrix exists (is not null)
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return NULL;
+    }
+    if(!checkMatrixIndex(b, k)){
+        return NULL;
+    }
+    if(dst->rows != b->rows || dst->cols != b->cols){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return NULL;
+    }
+    for(int i = 0; i < dst->rows; i++){
+        for(int j = 0; j < dst->cols; j++){
+            dst->data[MATRIX_ADDR(dst, i, j)] = b->data[MATRIX_BATCH_ADDR(b, k, i, j)];
+        }
+    }
+    return dst;
+}
+
+/*
+    c += a * b for n consecutive matrices, one element each.
+*/
+MATRIX_VECTORIZE static void batchMulAdd(int n, const double* restrict a, const double* restrict b, double* restrict c){
+    for(int l = 0; l < n; l++){
+        c[l] += a[l] * b[l];
+    }
+}
+
+/*
+    Arguments shared by the block tasks of a batched product.
+*/
+typedef struct {
+    matrixBatch* dst;
+    matrixBatch* b1;
+    matrixBatch* b2;
+} batchMulStep;
+
+static void batchMulTask(void* arg, int begin, int end){
+    batchMulStep* step = arg;
+    matrixBatch* dst = step->dst;
+    matrixBatch* b1 = step->b1;
+    matrixBatch* b2 = step->b2;
+    for(int block = begin; block < end; block++){
+        int k = block * MATRIX_BATCH_BLOCK;
+        int n = dst->count - k < MATRIX_BATCH_BLOCK ? dst->count - k : MATRIX_BATCH_BLOCK;
+        // Element (i, j) of every matrix is the dot product of row i of b1 and column j of b2
+        for(int i = 0; i < dst->rows; i++){
+            for(int j = 0; j < dst->cols; j++){
+                double* c = dst->data + MATRIX_BATCH_ADDR(dst, k, i, j);
+                memset(c, 0, sizeof(double) * n);
+                for(int p = 0; p < b1->cols; p++){
+                    batchMulAdd(n, b1->data + MATRIX_BATCH_ADDR(b1, k, i, p), b2->data + MATRIX_BATCH_ADDR(b2, k, p, j), c);
+                }
+            }
+        }
+    }
+}
+
+matrixBatch* matrixBatchMulInto(matrixBatch* dst, matrixBatch* b1, matrixBatch* b2){
+    // Check if batches exist (are not null)
+    if(b1 == NULL || b2 == NULL){
+        fprintf(stderr, "At least one of the batches isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that batch dimensions meet the operation requirements.
+    if(b1->count != b2->count || b1->cols != b2->rows){
+        fprintf(stderr, "Batch dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, b1->count, b1->rows, b2->cols)){
+        return NULL;
+    }
+    // The product reads b1 and b2 while writing dst, so they cannot share memory.
+    if(dst == b1 || dst == b2){
+        fprintf(stderr, "Destination of a batch product cannot be one of its operands.\n");
+        return NULL;
+    }
+    batchMulStep step = {dst, b1, b2};
+    batchRun(batchMulTask, &step, dst->count, (long long)dst->count * dst->rows * dst->cols * b1->cols);
+    return dst;
+}
+
+matrixBatch* matrixBatchMul(matrixBatch* b1, matrixBatch* b2){
+    // Check if batches exist (are not null)
+    if(b1 == NULL || b2 == NULL){
+        fprintf(stderr, "At least one of the batches isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that batch dimensions meet the operation requirements.
+    if(b1->count != b2->count || b1->cols != b2->rows){
+        fprintf(stderr, "Batch dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    matrixBatch* result = matrixBatchCreate(b1->count, b1->rows, b2->cols);
+    matrixBatchMulInto(result, b1, b2);
+    return result;
+}
+
+matrixBatch* matrixBatchAddInto(matrixBatch* dst, matrixBatch* b1, matrixBatch* b2){
+    // Check if batches exist (are not null)
+    if(b1 == NULL || b2 == NULL){
+        fprintf(stderr, "At least one of the batches isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that batch dimensions meet the operation requirements.
+    if(b1->count != b2->count || b1->rows != b2->rows || b1->cols != b2->cols){
+        fprintf(stderr, "Batch dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, b1->count, b1->rows, b1->cols)){
+        return NULL;
+    }
+    // Batches of equal dimensions share the layout, so the data arrays are added as a whole
+    matrixElementwiseKernels()->add((size_t)dst->rows * dst->cols * dst->stride, b1->data, b2->data, dst->data);
+    return dst;
+}
+
+matrixBatch* matrixBatchAdd(matrixBatch* b1, matrixBatch* b2){
+    // Check if batches exist (are not null)
+    if(b1 == NULL || b2 == NULL){
+        fprintf(stderr, "At least one of the batches isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that batch dimensions meet the operation requirements.
+    if(b1->count != b2->count || b1->rows != b2->rows || b1->cols != b2->cols){
+        fprintf(stderr, "Batch dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    matrixBatch* result = matrixBatchCreate(b1->count, b1->rows, b1->cols);
+    matrixBatchAddInto(result, b1, b2);
+    return result;
+}
+
+matrixBatch* matrixBatchTransposeInto(matrixBatch* dst, matrixBatch* b){
+    // Check if batch exists (is not null)
+    if(b == NULL){
+        fprintf(stderr, "Batch does not exist.\n");
+        return NULL;
+    }
+    if(!checkDestination(dst, b->count, b->cols, b->rows)){
+        return NULL;
+    }
+    // Every array is read from another position, so the operand cannot be overwritten.
+    if(dst == b){
+        fprintf(stderr, "Destination of a transpose cannot be its operand.\n");
+        return NULL;
+    }
+    // Transposing moves whole (i, j) arrays, which are copied at once
+    for(int i = 0; i < b->rows; i++){
+        for(int j = 0; j < b->cols; j++){
+            memcpy(dst->data + MATRIX_BATCH_ADDR(dst, 0, j, i), b->data + MATRIX_BATCH_ADDR(b, 0, i, j), sizeof(double) * b->stride);
+        }
+    }
+    return dst;
+}
+
+matrixBatch* matrixBatchTranspose(matrixBatch* b){
+    // Check if batch exists (is not null)
+    if(b == NULL){
+        fprintf(stderr, "Batch does not exist.\n");
+        return NULL;
+    }
+    matrixBatch* result = matrixBatchCreate(b->count, b->cols, b->rows);
+    matrixBatchTransposeInto(result, b);
+    return result;
+}
+
+/*
+    Closed-form determinants of n consecutive 2x2, 3x3 and 4x4 matrices.
+    Element (i, j) of matrix l is a[(i * size + j) * s + l].
+*/
+MATRIX_VECTORIZE static void batchDet2(int n, const double* restrict a, size_t s, double* restrict det){
+    for(int l = 0; l < n; l++){
+        det[l] = a[l] * a[3 * s + l] - a[s + l] * a[2 * s + l];
+    }
+}
+
+MATRIX_VECTORIZE static void batchDet3(int n, const double* restrict a, size_t s, double* restrict det){
+    for(int l = 0; l < n; l++){
+        double a00 = a[l], a01 = a[s + l], a02 = a[2 * s + l];
+        double a10 = a[3 * s + l], a11 = a[4 * s + l], a12 = a[5 * s + l];
+        double a20 = a[6 * s + l], a21 = a[7 * s + l], a22 = a[8 * s + l];
+        det[l] = a00 * (a11 * a22 - a12 * a21) - a01 * (a10 * a22 - a12 * a20) + a02 * (a10 * a21 - a11 * a20);
+    }
+}
+
+MATRIX_VECTORIZE static void batchDet4(int n, const double* restrict a, size_t s, double* restrict det){
+    for(int l = 0; l < n; l++){
+        double a00 = a[l], a01 = a[s + l], a02 = a[2 * s + l], a03 = a[3 * s + l];
+        double a10 = a[4 * s + l], a11 = a[5 * s + l], a12 = a[6 * s + l], a13 = a[7 * s + l];
+        double a20 = a[8 * s + l], a21 = a[9 * s + l], a22 = a[10 * s + l], a23 = a[11 * s + l];
+        double a30 = a[12 * s + l], a31 = a[13 * s + l], a32 = a[14 * s + l], a33 = a[15 * s + l];
+        // Laplace expansion along the first two rows: 2x2 minors of the top
+        // rows times the complementary 2x2 minors of the bottom rows
+        double s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02, s2 = a00 * a13 - a10 * a03;
+        double s3 = a01 * a12 - a11 * a02, s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+        double c0 = a20 * a31 - a30 * a21, c1 = a20 * a32 - a30 * a22, c2 = a20 * a33 - a30 * a23;
+        double c3 = a21 * a32 - a31 * a22, c4 = a21 * a33 - a31 * a23, c5 = a22 * a33 - a32 * a23;
+        det[l] = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+/*
+    Arguments shared by the block tasks of a batched determinant.
+*/
+typedef struct {
+    matrixBatch* b;
+    double* det;
+} batchDetStep;
+
+static void batchDetTask(void* arg, int begin, int end){
+    batchDetStep* step = arg;
+    matrixBatch* b = step->b;
+    matrix* tmp = NULL;
+    for(int block = begin; block < end; block++){
+        int k = block * MATRIX_BATCH_BLOCK;
+        int n = b->count - k < MATRIX_BATCH_BLOCK ? b->count - k : MATRIX_BATCH_BLOCK;
+        const double* a = b->data + k;
+        double* det = step->det + k;
+        switch(b->rows){
+            case 0:
+                for(int l = 0; l < n; l++){
+                    det[l] = 1.0;
+                }
+                break;
+            case 1:
+                memcpy(det, a, sizeof(double) * n);
+                break;
+            case 2:
+                batchDet2(n, a, b->stride, det);
+                break;
+            case 3:
+                batchDet3(n, a, b->stride, det);
+                break;
+            case 4:
+                batchDet4(n, a, b->stride, det);
+                break;
+            default:
+                // Larger matrices are gathered one by one and factorized
+                if(tmp == NULL){
+                    tmp = matrixCreateWith(b->rows, b->cols, MATRIX_CREATE_UNINITIALIZED);
+                }
+                for(int l = 0; l < n; l++){
+                    matrixBatchGetMatrix(tmp, b, k + l);
+                    det[l] = matrixDet(tmp);
+                }
+                break;
+        }
+    }
+    matrixDelete(tmp);
+}
+
+double* matrixBatchDet(matrixBatch* b, double* det){
+    // Check if batch and output array exist (are not null)
+    if(b == NULL || det == NULL){
+        fprintf(stderr, "Batch or output array does not exist.\n");
+        return NULL;
+    }
+    // Check if matrices are square
+    if(b->rows != b->cols){
+        fprintf(stderr, "Cannot compute determinant of a non-square matrix.\n");
+        return NULL;
+    }
+    batchDetStep step = {b, det};
+    batchRun(batchDetTask, &step, b->count, (long long)b->count * b->rows * b->cols);
+    return det;
+}
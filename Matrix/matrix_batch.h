@@ -0,0 +1,143 @@
+#ifndef MATRIX_BATCH_H
+#define MATRIX_BATCH_H
+
+#include "matrix.h"
+
+/**
+ * Compute the index of element (i, j) of matrix k in the data array of a batch.
+ */
+#define MATRIX_BATCH_ADDR(b, k, i, j) (((size_t)(i) * (b)->cols + (j)) * (b)->stride + (k))
+
+/**
+ * Structure holding `count` small matrices of the same shape in
+ * structure-of-arrays layout: element (i, j) of all matrices is stored
+ * in one contiguous, aligned array, so kernels vectorize across the batch.
+ */
+typedef struct {
+    int count;      /** Number of matrices in the batch */
+    int rows;       /** Number of rows of every matrix */
+    int cols;       /** Number of columns of every matrix */
+    int stride;     /** Number of elements between the arrays of consecutive (i, j) (>= count) */
+    double* data;   /** Pointer to the elements */
+} matrixBatch;
+
+/**
+ * Create a batch of `count` rows × cols matrices, filled with zeros.
+ * Function allocates memory for the batch automatically (a single aligned block).
+ * @param count Number of matrices
+ * @param rows Number of rows of every matrix
+ * @param cols Number of columns of every matrix
+ * @return Pointer to the newly created batch, or NULL if a dimension is negative
+ */
+matrixBatch* matrixBatchCreate(int count, int rows, int cols);
+
+/**
+ * Free the memory associated with the batch.
+ * @param b Pointer to the batch to delete
+ */
+void matrixBatchDelete(matrixBatch* b);
+
+/**
+ * Get the value at position (i, j) of matrix k in the batch.
+ * @param b Pointer to the batch
+ * @param k Index of the matrix
+ * @param i Row index
+ * @param j Column index
+ * @return The value stored at position (i, j), or -1 on invalid arguments
+ */
+double matrixBatchGetValue(matrixBatch* b, int k, int i, int j);
+
+/**
+ * Set the value at position (i, j) of matrix k in the batch.
+ * @param b Pointer to the batch
+ * @param k Index of the matrix
+ * @param i Row index
+ * @param j Column index
+ * @param value Value to set at (i, j)
+ */
+void matrixBatchSetValue(matrixBatch* b, int k, int i, int j, double value);
+
+/**
+ * Copy a matrix into position k of the batch.
+ * @param b Pointer to the batch
+ * @param k Index of the matrix
+ * @param m Pointer to the matrix with the dimensions of the batch
+ * @return b, or NULL on invalid arguments
+ */
+matrixBatch* matrixBatchSetMatrix(matrixBatch* b, int k, matrix* m);
+
+/**
+ * Copy matrix k of the batch into an existing matrix.
+ * @param dst Pointer to the destination matrix with the dimensions of the batch
+ * @param b Pointer to the batch
+ * @param k Index of the matrix
+ * @return dst, or NULL on invalid arguments
+ */
+matrix* matrixBatchGetMatrix(matrix* dst, matrixBatch* b, int k);
+
+/**
+ * Multiply corresponding matrices of two batches (b1[k] × b2[k]) into an existing batch.
+ * No memory is allocated; dst must not be one of the operands.
+ * @param dst Pointer to the destination batch (count matrices of b1->rows × b2->cols)
+ * @param b1 Pointer to the first batch
+ * @param b2 Pointer to the second batch
+ * @return dst, or NULL if dimensions are invalid
+ */
+matrixBatch* matrixBatchMulInto(matrixBatch* dst, matrixBatch* b1, matrixBatch* b2);
+
+/**
+ * Multiply corresponding matrices of two batches (b1[k] × b2[k]).
+ * Function allocates memory for the batch automatically.
+ * @param b1 Pointer to the first batch
+ * @param b2 Pointer to the second batch
+ * @return Pointer to the resulting batch, or NULL if dimensions are invalid
+ */
+matrixBatch* matrixBatchMul(matrixBatch* b1, matrixBatch* b2);
+
+/**
+ * Add corresponding matrices of two batches (b1[k] + b2[k]) into an existing batch.
+ * No memory is allocated; dst may be b1 or b2 to add in place.
+ * @param dst Pointer to the destination batch of the same dimensions
+ * @param b1 Pointer to the first batch
+ * @param b2 Pointer to the second batch
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixBatch* matrixBatchAddInto(matrixBatch* dst, matrixBatch* b1, matrixBatch* b2);
+
+/**
+ * Add corresponding matrices of two batches (b1[k] + b2[k]).
+ * Function allocates memory for the batch automatically.
+ * @param b1 Pointer to the first batch
+ * @param b2 Pointer to the second batch
+ * @return Pointer to the resulting batch, or NULL if dimensions mismatch
+ */
+matrixBatch* matrixBatchAdd(matrixBatch* b1, matrixBatch* b2);
+
+/**
+ * Transpose every matrix of a batch into an existing batch.
+ * No memory is allocated; dst must not be b.
+ * @param dst Pointer to the destination batch (count matrices of b->cols × b->rows)
+ * @param b Pointer to the batch
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixBatch* matrixBatchTransposeInto(matrixBatch* dst, matrixBatch* b);
+
+/**
+ * Transpose every matrix of a batch.
+ * Function allocates memory for the batch automatically.
+ * @param b Pointer to the batch
+ * @return Pointer to the transposed batch
+ */
+matrixBatch* matrixBatchTranspose(matrixBatch* b);
+
+/**
+ * Compute the determinant of every matrix of a batch of square matrices.
+ * Matrices up to 4 × 4 use closed-form cofactor expansions vectorized
+ * across the batch; larger ones are computed one by one with matrixDet.
+ * @param b Pointer to the batch
+ * @param det Output array of b->count determinants
+ * @return det, or NULL on invalid arguments
+ */
+double* matrixBatchDet(matrixBatch* b, double* det);
+
+#endif /* MATRIX_BATCH_H */
@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+#include "matrix_expr.h"
+#include "matrix_arena.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Number of elements of a row evaluated at once. Every node of the
+    expression needs at most two chunk buffers, which stay in L1/L2.
+*/
+#ifndef MATRIX_EXPR_CHUNK
+#define MATRIX_EXPR_CHUNK 512
+#endif
+
+/*
+    Expressions with fewer result elements than this are evaluated on
+    the calling thread, because waking the worker pool would cost more
+    than it saves.
+*/
+#ifndef MATRIX_EXPR_PARALLEL_THRESHOLD
+#define MATRIX_EXPR_PARALLEL_THRESHOLD (256 * 1024)
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Allocate an expression node with the given operation and dimensions.
+*/
+static matrixExpr* exprAllocate(matrixExprOp op, int rows, int cols){
+    matrixExpr* e = malloc(sizeof(matrixExpr));
+    if(e == NULL){
+        allocationFailure();
+    }
+    e->op = op;
+    e->rows = rows;
+    e->cols = cols;
+    e->m = NULL;
+    e->value = 0.0;
+    e->left = NULL;
+    e->right = NULL;
+    return e;
+}
+
+/*
+    Create a binary node. Scalar operands are broadcast; two scalars are
+    folded into a single scalar leaf right away.
+*/
+static matrixExpr* exprBinary(matrixExprOp op, matrixExpr* e1, matrixExpr* e2){
+    // Check if operands exist (are not null)
+    if(e1 == NULL || e2 == NULL){
+        fprintf(stderr, "At least one of the expressions isn't allocated.\n");
+        matrixExprDelete(e1);
+        matrixExprDelete(e2);
+        return NULL;
+    }
+    if(e1->op == MATRIX_EXPR_SCALAR && e2->op == MATRIX_EXPR_SCALAR){
+        double a = e1->value, b = e2->value;
+        e1->value = op == MATRIX_EXPR_ADD ? a + b : op == MATRIX_EXPR_SUB ? a - b : a * b;
+        matrixExprDelete(e2);
+        return e1;
+    }
+    // Verify that dimensions meet the operation requirements.
+    if(e1->rows >= 0 && e2->rows >= 0 && (e1->rows != e2->rows || e1->cols != e2->cols)){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        matrixExprDelete(e1);
+        matrixExprDelete(e2);
+        return NULL;
+    }
+    matrixExpr* e = exprAllocate(op, e1->rows >= 0 ? e1->rows : e2->rows, e1->rows >= 0 ? e1->cols : e2->cols);
+    e->left = e1;
+    e->right = e2;
+    return e;
+}
+
+matrixExpr* matrixExprMatrix(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    matrixExpr* e = exprAllocate(MATRIX_EXPR_MATRIX, m->rows, m->cols);
+    e->m = m;
+    return e;
+}
+
+matrixExpr* matrixExprScalar(double value){
+    matrixExpr* e = exprAllocate(MATRIX_EXPR_SCALAR, -1, -1);
+    e->value = value;
+    return e;
+}
+
+matrixExpr* matrixExprAdd(matrixExpr* e1, matrixExpr* e2){
+    return exprBinary(MATRIX_EXPR_ADD, e1, e2);
+}
+
+matrixExpr* matrixExprSub(matrixExpr* e1, matrixExpr* e2){
+    return exprBinary(MATRIX_EXPR_SUB, e1, e2);
+}
+
+matrixExpr* matrixExprMul(matrixExpr* e1, matrixExpr* e2){
+    return exprBinary(MATRIX_EXPR_MUL, e1, e2);
+}
+
+matrixExpr* matrixExprScale(matrixExpr* e, double value){
+    return exprBinary(MATRIX_EXPR_MUL, e, matrixExprScalar(value));
+}
+
+void matrixExprDelete(matrixExpr* e){
+    // Free the node and its operands if it exists (non-null pointer).
+    if(e != NULL){
+        matrixExprDelete(e->left);
+        matrixExprDelete(e->right);
+        free(e);
+    }
+    return;
+}
+
+/*
+    Number of chunk buffers needed to evaluate the subtree of e:
+    the two operand results of a binary node plus the buffers of the
+    deeper of its subtrees.
+*/
+static int exprBuffers(const matrixExpr* e){
+    if(e->op == MATRIX_EXPR_MATRIX || e->op == MATRIX_EXPR_SCALAR){
+        return 0;
+    }
+    int left = exprBuffers(e->left), right = exprBuffers(e->right);
+    return 2 + (left > right ? left : right);
+}
+
+/*
+    If e is the product of an expression and a scalar, return that
+    expression and store the scalar in *s; otherwise return NULL.
+*/
+static const matrixExpr* exprScaledOperand(const matrixExpr* e, double* s){
+    if(e->op != MATRIX_EXPR_MUL){
+        return NULL;
+    }
+    if(e->right->op == MATRIX_EXPR_SCALAR){
+        *s = e->right->value;
+        return e->left;
+    }
+    if(e->left->op == MATRIX_EXPR_SCALAR){
+        *s = e->left->value;
+        return e->right;
+    }
+    return NULL;
+}
+
+/*
+    Evaluate n elements of row i, starting at column j, of a non-scalar
+    expression. Leaves return a pointer into their matrix without copying;
+    other nodes write into `out` and use `pool` for their operands.
+*/
+static const double* exprEvalChunk(const matrixExpr* e, int i, int j, int n, double* out, double* pool, const elementwiseKernels* k){
+    if(e->op == MATRIX_EXPR_MATRIX){
+        return e->m->data + MATRIX_ADDR(e->m, i, j);
+    }
+    const matrixExpr* left = e->left;
+    const matrixExpr* right = e->right;
+    double* first = pool;
+    double* second = pool + MATRIX_EXPR_CHUNK;
+    double* rest = pool + 2 * MATRIX_EXPR_CHUNK;
+    const matrixExpr* x;
+    double s;
+
+    // a * s + b and b - a * s are computed by one AXPY pass
+    if(e->op == MATRIX_EXPR_ADD && right->op != MATRIX_EXPR_SCALAR && (x = exprScaledOperand(left, &s)) != NULL){
+        k->axpy(n, exprEvalChunk(x, i, j, n, first, rest, k), s, exprEvalChunk(right, i, j, n, second, rest, k), out);
+        return out;
+    }
+    if(e->op != MATRIX_EXPR_MUL && left->op != MATRIX_EXPR_SCALAR && (x = exprScaledOperand(right, &s)) != NULL){
+        s = e->op == MATRIX_EXPR_SUB ? -s : s;
+        k->axpy(n, exprEvalChunk(x, i, j, n, first, rest, k), s, exprEvalChunk(left, i, j, n, second, rest, k), out);
+        return out;
+    }
+    // A scalar operand is applied with the scalar kernels
+    if(left->op == MATRIX_EXPR_SCALAR){
+        const double* b = exprEvalChunk(right, i, j, n, first, rest, k);
+        if(e->op == MATRIX_EXPR_ADD){
+            k->addScalar(n, b, left->value, out);
+        }
+        else if(e->op == MATRIX_EXPR_MUL){
+            k->mulScalar(n, b, left->value, out);
+        }
+        else{
+            // s - b = -b + s
+            k->mulScalar(n, b, -1.0, out);
+            k->addScalar(n, out, left->value, out);
+        }
+        return out;
+    }
+    if(right->op == MATRIX_EXPR_SCALAR){
+        const double* a = exprEvalChunk(left, i, j, n, first, rest, k);
+        if(e->op == MATRIX_EXPR_MUL){
+            k->mulScalar(n, a, right->value, out);
+        }
+        else{
+            k->addScalar(n, a, e->op == MATRIX_EXPR_ADD ? right->value : -right->value, out);
+        }
+        return out;
+    }
+    const double* a = exprEvalChunk(left, i, j, n, first, rest, k);
+    const double* b = exprEvalChunk(right, i, j, n, second, rest, k);
+    if(e->op == MATRIX_EXPR_ADD){
+        k->add(n, a, b, out);
+    }
+    else if(e->op == MATRIX_EXPR_SUB){
+        k->sub(n, a, b, out);
+    }
+    else{
+        k->mul(n, a, b, out);
+    }
+    return out;
+}
+
+/*
+    Static helper checking that dst is either exactly a referenced matrix
+    (the chunks of every row are read before they are written) or does
+    not share memory with any of them.
+*/
+static int exprCheckAlias(const matrixExpr* e, matrix* dst){
+    if(e == NULL){
+        return 1;
+    }
+    if(e->op == MATRIX_EXPR_MATRIX && matrixOverlaps(dst, e->m) && (dst->data != e->m->data || dst->stride != e->m->stride)){
+        fprintf(stderr, "Destination partially overlaps an operand.\n");
+        return 0;
+    }
+    return exprCheckAlias(e->left, dst) && exprCheckAlias(e->right, dst);
+}
+
+/*
+    Arguments shared by the row tasks of one evaluation.
+*/
+typedef struct {
+    const matrixExpr* e;
+    matrix* dst;
+    int buffers;    /* Chunk buffers needed per task */
+} exprEvaluation;
+
+/*
+    Evaluate the rows [begin, end) of the expression into dst.
+*/
+static void exprEvalTask(void* arg, int begin, int end){
+    exprEvaluation* ev = arg;
+    const elementwiseKernels* k = matrixElementwiseKernels();
+    matrix* dst = ev->dst;
+    // The chunk buffers come from the scratch arena of the thread running the task
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    double* pool = matrixArenaAlloc(arena, sizeof(double) * MATRIX_EXPR_CHUNK * ev->buffers);
+    for(int i = begin; i < end; i++){
+        double* row = dst->data + MATRIX_ADDR(dst, i, 0);
+        for(int j = 0; j < dst->cols; j += MATRIX_EXPR_CHUNK){
+            int n = dst->cols - j < MATRIX_EXPR_CHUNK ? dst->cols - j : MATRIX_EXPR_CHUNK;
+            if(ev->e->op == MATRIX_EXPR_SCALAR){
+                for(int c = 0; c < n; c++){
+                    row[j + c] = ev->e->value;
+                }
+                continue;
+            }
+            // The root writes straight into dst; a bare leaf has to be copied
+            const double* result = exprEvalChunk(ev->e, i, j, n, row + j, pool, k);
+            if(result != row + j){
+                memcpy(row + j, result, sizeof(double) * n);
+            }
+        }
+    }
+    matrixArenaRelease(arena, mark);
+}
+
+matrix* matrixExprEvalInto(matrix* dst, matrixExpr* e){
+    // Check if expression exists (is not null)
+    if(e == NULL){
+        fprintf(stderr, "Expression does not exist.\n");
+        return NULL;
+    }
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return NULL;
+    }
+    // A scalar expression is broadcast, any other must match the destination
+    if(e->rows >= 0 && (dst->rows != e->rows || dst->cols != e->cols)){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return NULL;
+    }
+    if(!exprCheckAlias(e, dst)){
+        return NULL;
+    }
+    exprEvaluation ev = {e, dst, exprBuffers(e)};
+    if((long long)dst->rows * dst->cols < MATRIX_EXPR_PARALLEL_THRESHOLD){
+        exprEvalTask(&ev, 0, dst->rows);
+    }
+    else{
+        // Hand out about 16K elements per task
+        int grain = dst->cols < 16384 ? 16384 / dst->cols : 1;
+        matrixParallelFor(dst->rows, grain, exprEvalTask, &ev);
+    }
+    return dst;
+}
+
+matrix* matrixExprEval(matrixExpr* e){
+    // Check if expression exists (is not null)
+    if(e == NULL){
+        fprintf(stderr, "Expression does not exist.\n");
+        return NULL;
+    }
+    // A scalar has no dimensions of its own
+    if(e->rows < 0){
+        fprintf(stderr, "Cannot evaluate a scalar expression into a new matrix.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(e->rows, e->cols, MATRIX_CREATE_UNINITIALIZED);
+
+    // Evaluate the expression into the new matrix.
+    matrixExprEvalInto(result, e);
+
+    // Return pointer to a new matrix
+    return result;
+}
@@ -0,0 +1,117 @@
+#ifndef MATRIX_EXPR_H
+#define MATRIX_EXPR_H
+
+#include "matrix.h"
+
+/**
+ * Operations available in a matrix expression.
+ * All binary operations work element by element.
+ */
+typedef enum {
+    MATRIX_EXPR_MATRIX,     /** Leaf referencing a matrix */
+    MATRIX_EXPR_SCALAR,     /** Leaf holding a scalar, broadcast to every element */
+    MATRIX_EXPR_ADD,        /** left + right */
+    MATRIX_EXPR_SUB,        /** left - right */
+    MATRIX_EXPR_MUL         /** left * right (element-wise product) */
+} matrixExprOp;
+
+/**
+ * Node of a lazy element-wise matrix expression.
+ *
+ * Building an expression does not compute anything; matrixExprEvalInto
+ * evaluates the whole tree in a single pass over memory, one cache-sized
+ * chunk of a row at a time, without full-size temporaries.
+ * Every node owns its operands, so deleting the root frees the whole tree,
+ * and a node may be used as an operand only once.
+ */
+typedef struct matrixExpr {
+    matrixExprOp op;            /** Operation of the node */
+    int rows;                   /** Number of rows of the result (-1 for scalars) */
+    int cols;                   /** Number of columns of the result (-1 for scalars) */
+    matrix* m;                  /** Referenced matrix (MATRIX_EXPR_MATRIX), not owned */
+    double value;               /** Scalar value (MATRIX_EXPR_SCALAR) */
+    struct matrixExpr* left;    /** First operand of binary operations */
+    struct matrixExpr* right;   /** Second operand of binary operations */
+} matrixExpr;
+
+/**
+ * Create an expression leaf referencing a matrix.
+ * The matrix is not copied and must stay alive until the expression is evaluated.
+ * Function allocates memory for the node automatically.
+ * @param m Pointer to the matrix (or view)
+ * @return Pointer to the new node, or NULL if m is NULL
+ */
+matrixExpr* matrixExprMatrix(matrix* m);
+
+/**
+ * Create an expression leaf holding a scalar, broadcast to every element.
+ * Function allocates memory for the node automatically.
+ * @param value Scalar value
+ * @return Pointer to the new node
+ */
+matrixExpr* matrixExprScalar(double value);
+
+/**
+ * Create the element-wise sum of two expressions (e1 + e2).
+ * Takes ownership of both operands; they are freed if the node cannot be created.
+ * @param e1 First operand
+ * @param e2 Second operand
+ * @return Pointer to the new node, or NULL if an operand is NULL or dimensions mismatch
+ */
+matrixExpr* matrixExprAdd(matrixExpr* e1, matrixExpr* e2);
+
+/**
+ * Create the element-wise difference of two expressions (e1 - e2).
+ * Takes ownership of both operands; they are freed if the node cannot be created.
+ * @param e1 First operand
+ * @param e2 Second operand
+ * @return Pointer to the new node, or NULL if an operand is NULL or dimensions mismatch
+ */
+matrixExpr* matrixExprSub(matrixExpr* e1, matrixExpr* e2);
+
+/**
+ * Create the element-wise product of two expressions (e1 * e2).
+ * Takes ownership of both operands; they are freed if the node cannot be created.
+ * @param e1 First operand
+ * @param e2 Second operand
+ * @return Pointer to the new node, or NULL if an operand is NULL or dimensions mismatch
+ */
+matrixExpr* matrixExprMul(matrixExpr* e1, matrixExpr* e2);
+
+/**
+ * Create the product of an expression and a scalar (e * value).
+ * Takes ownership of the operand; it is freed if the node cannot be created.
+ * @param e Operand
+ * @param value Scalar value
+ * @return Pointer to the new node, or NULL if e is NULL
+ */
+matrixExpr* matrixExprScale(matrixExpr* e, double value);
+
+/**
+ * Free an expression and all of its operands.
+ * Referenced matrices are not freed.
+ * @param e Pointer to the root of the expression
+ */
+void matrixExprDelete(matrixExpr* e);
+
+/**
+ * Evaluate an expression into an existing matrix in one fused pass.
+ * Sums of a scaled operand and another operand (a * s + b) are computed
+ * by a single AXPY kernel. Large results are evaluated in parallel by rows.
+ * No memory proportional to the matrix size is allocated; dst may be one of
+ * the referenced matrices, but must not partially overlap any of them.
+ * @param dst Pointer to the destination matrix with the dimensions of the expression
+ * @param e Pointer to the expression (not freed)
+ * @return dst, or NULL on invalid arguments
+ */
+matrix* matrixExprEvalInto(matrix* dst, matrixExpr* e);
+
+/**
+ * Evaluate an expression into a new matrix in one fused pass.
+ * Function allocates memory for the matrix automatically.
+ * @param e Pointer to the expression (not freed)
+ * @return Pointer to the resulting matrix, or NULL if e is NULL or a scalar
+ */
+matrix* matrixExprEval(matrixExpr* e);
+
+#endif /* MATRIX_EXPR_H */
@@ -0,0 +1,233 @@
+/*
+    Declarations of a matrix type with a custom element type.
+
+    This file has no include guard: matrix_typed.h includes it once per
+    element type, with the following macros defined:
+        MATRIX_GENERIC_TYPE     element type (e.g. float)
+        MATRIX_GENERIC_MATRIX   name of the matrix structure (e.g. matrixF32)
+        MATRIX_GENERIC_FN(name) name of a function (e.g. matrixF32##name)
+*/
+
+/**
+ * Structure representing a dynamic matrix stored in row-major order,
+ * laid out like `matrix` (including views and row strides).
+ */
+typedef struct {
+    int rows;                   /** Number of rows in the matrix */
+    int cols;                   /** Number of columns in the matrix */
+    MATRIX_GENERIC_TYPE* data;  /** Pointer to the first matrix element */
+    int stride;                 /** Number of elements between the starts of consecutive rows (>= cols) */
+    int ownsData;               /** Nonzero if `data` is freed together with the matrix */
+} MATRIX_GENERIC_MATRIX;
+
+/**
+ * Create a new matrix with given dimensions, filled with zeros.
+ * Function allocates memory for the matrix automatically.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @return Pointer to the newly created matrix, or NULL if dimensions are negative
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Create)(int rows, int cols);
+
+/**
+ * Create a new matrix with given dimensions and allocation flags (see matrixCreateWith).
+ * Function allocates memory for the matrix automatically.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param flags Combination of matrixCreateFlags
+ * @return Pointer to the newly created matrix, or NULL if dimensions are negative
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(CreateWith)(int rows, int cols, int flags);
+
+/**
+ * Free the memory associated with the matrix, and its data array unless it is a view.
+ * @param m Pointer to the matrix to delete
+ */
+void MATRIX_GENERIC_FN(Delete)(MATRIX_GENERIC_MATRIX* m);
+
+/**
+ * Create a view of the rows × cols block of m starting at (row, col) (see matrixView).
+ * @param m Pointer to the parent matrix
+ * @param row First row of the block
+ * @param col First column of the block
+ * @param rows Number of rows of the block
+ * @param cols Number of columns of the block
+ * @return Pointer to the newly created view, or NULL if the block does not fit in m
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(View)(MATRIX_GENERIC_MATRIX* m, int row, int col, int rows, int cols);
+
+/**
+ * Initialize a caller-provided matrix as a view without allocating (see matrixViewInit).
+ * @param view Pointer to the matrix structure to fill
+ * @param m Pointer to the parent matrix
+ * @param row First row of the block
+ * @param col First column of the block
+ * @param rows Number of rows of the block
+ * @param cols Number of columns of the block
+ * @return view, or NULL if the block does not fit in m
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(ViewInit)(MATRIX_GENERIC_MATRIX* view, MATRIX_GENERIC_MATRIX* m, int row, int col, int rows, int cols);
+
+/**
+ * Check whether two matrices (or views) may share elements.
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return 1 if the memory ranges of the matrices overlap, 0 otherwise
+ */
+int MATRIX_GENERIC_FN(Overlaps)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Get the value at position (i, j) in the matrix.
+ * @param m Pointer to the matrix
+ * @param i Row index
+ * @param j Column index
+ * @return The value stored at position (i, j), or -1 on invalid arguments
+ */
+MATRIX_GENERIC_TYPE MATRIX_GENERIC_FN(GetValue)(MATRIX_GENERIC_MATRIX* m, int i, int j);
+
+/**
+ * Set the value at position (i, j) in the matrix.
+ * @param m Pointer to the matrix
+ * @param i Row index
+ * @param j Column index
+ * @param value Value to set at (i, j)
+ */
+void MATRIX_GENERIC_FN(SetValue)(MATRIX_GENERIC_MATRIX* m, int i, int j, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Print the matrix to stdout.
+ * @param m Pointer to the matrix to print
+ */
+void MATRIX_GENERIC_FN(Print)(MATRIX_GENERIC_MATRIX* m);
+
+/**
+ * Multiply two matrices (m1 × m2) into an existing matrix.
+ * Large products are computed in parallel by rows.
+ * No memory is allocated; dst must not overlap the operands.
+ * @param dst Pointer to the destination matrix (m1->rows × m2->cols)
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions are invalid
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Multiply two matrices (m1 × m2).
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return Pointer to the resulting matrix, or NULL if dimensions are invalid
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Mul)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Add two matrices (m1 + m2) into an existing matrix.
+ * No memory is allocated; dst may be m1 or m2, but must not partially overlap them.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Add two matrices (m1 + m2).
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return Pointer to the resulting matrix, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Add)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Subtract two matrices (m1 - m2) into an existing matrix.
+ * No memory is allocated; dst may be m1 or m2, but must not partially overlap them.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Subtract two matrices (m1 - m2).
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the first matrix
+ * @param m2 Pointer to the second matrix
+ * @return Pointer to the resulting matrix, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Sub)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2);
+
+/**
+ * Add a scalar value to all elements of the matrix into an existing matrix.
+ * No memory is allocated; dst may be m1, but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to add
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Add a scalar value to all elements of the matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to add
+ * @return Pointer to the resulting matrix
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Subtract a scalar value from all elements of the matrix into an existing matrix.
+ * No memory is allocated; dst may be m1, but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to subtract
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Subtract a scalar value from all elements of the matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to subtract
+ * @return Pointer to the resulting matrix
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Multiply all elements of a matrix by a scalar value into an existing matrix.
+ * No memory is allocated; dst may be m1, but must not partially overlap it.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to multiply
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Multiply all elements of a matrix by a scalar value.
+ * Function allocates memory for the matrix automatically.
+ * @param m1 Pointer to the matrix
+ * @param value Scalar value to multiply
+ * @return Pointer to the resulting matrix
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value);
+
+/**
+ * Compute the transpose of a matrix into an existing matrix.
+ * No memory is allocated; dst must not overlap m.
+ * @param dst Pointer to the destination matrix (m->cols × m->rows)
+ * @param m Pointer to the matrix
+ * @return dst, or NULL if dimensions mismatch
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(TransposeInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m);
+
+/**
+ * Compute the transpose of a matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix
+ * @return Pointer to the transposed matrix
+ */
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Transpose)(MATRIX_GENERIC_MATRIX* m);
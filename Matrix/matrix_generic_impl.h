@@ -0,0 +1,481 @@
+/*
+    Implementation of a matrix type with a custom element type.
+
+    This file has no include guard: matrix_typed.c includes it once per
+    element type, with the macros of matrix_generic.h and the following
+    ones defined:
+        MATRIX_GENERIC_ACC          type used to accumulate products
+        MATRIX_GENERIC_PRINT(v)     print one element to stdout
+*/
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(CreateWith)(int rows, int cols, int flags){
+    // Check if dimensions are positive
+    if(rows < 0 || cols < 0){
+        fprintf(stderr, "Matrix dimensions could not be negative.\n");
+        return NULL;
+    }
+    // Allocate memory for new matrix
+    MATRIX_GENERIC_MATRIX* m = malloc(sizeof(MATRIX_GENERIC_MATRIX));
+    // Check if allocation was successfull
+    if(m == NULL){
+        allocationFailure();
+    }
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = cols;
+    m->ownsData = 1;
+    if(flags & MATRIX_CREATE_ALIGNED){
+        // Pad every row to whole cache lines, avoiding strides of a multiple of 4 KiB
+        const int line = MATRIX_ALIGNMENT / sizeof(MATRIX_GENERIC_TYPE);
+        m->stride = (cols + line - 1) / line * line;
+        if(m->stride > 0 && m->stride % (4096 / sizeof(MATRIX_GENERIC_TYPE)) == 0){
+            m->stride += line;
+        }
+        // aligned_alloc requires the size to be a nonzero multiple of the alignment
+        size_t bytes = (size_t)rows * m->stride * sizeof(MATRIX_GENERIC_TYPE);
+        m->data = aligned_alloc(MATRIX_ALIGNMENT, bytes > 0 ? bytes : MATRIX_ALIGNMENT);
+        if(m->data == NULL){
+            allocationFailure();
+        }
+        if(!(flags & MATRIX_CREATE_UNINITIALIZED)){
+            memset(m->data, 0, bytes);
+        }
+        return m;
+    }
+    // Allocate memory for data array, filled with zeros unless asked otherwise.
+    if(flags & MATRIX_CREATE_UNINITIALIZED){
+        m->data = malloc((size_t)rows * cols * sizeof(MATRIX_GENERIC_TYPE));
+    }
+    else{
+        m->data = calloc((size_t)rows * cols, sizeof(MATRIX_GENERIC_TYPE));
+    }
+    // Check if allocation was successfull
+    if((m->data) == NULL && (size_t)rows * cols > 0){
+        allocationFailure();
+    }
+    // Return pointer to a new matrix
+    return m;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Create)(int rows, int cols){
+    return MATRIX_GENERIC_FN(CreateWith)(rows, cols, MATRIX_CREATE_DEFAULT);
+}
+
+void MATRIX_GENERIC_FN(Delete)(MATRIX_GENERIC_MATRIX* m){
+    // Free the matrix if it exists (non-null pointer), and its data array unless it is a view.
+    if(m != NULL){
+        if(m->ownsData){
+            free(m->data);
+        }
+        free(m);
+    }
+    return;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(ViewInit)(MATRIX_GENERIC_MATRIX* view, MATRIX_GENERIC_MATRIX* m, int row, int col, int rows, int cols){
+    // Check if matrices exist (are not null)
+    if(view == NULL || m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check if the block lies inside the parent matrix
+    if(row < 0 || col < 0 || rows < 0 || cols < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return NULL;
+    }
+    if(row > m->rows - rows || col > m->cols - cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return NULL;
+    }
+    view->rows = rows;
+    view->cols = cols;
+    view->stride = m->stride;
+    view->ownsData = 0;
+    view->data = m->data + MATRIX_ADDR(m, row, col);
+    return view;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(View)(MATRIX_GENERIC_MATRIX* m, int row, int col, int rows, int cols){
+    // Allocate memory for the view header
+    MATRIX_GENERIC_MATRIX* view = malloc(sizeof(MATRIX_GENERIC_MATRIX));
+    if(view == NULL){
+        allocationFailure();
+    }
+    if(MATRIX_GENERIC_FN(ViewInit)(view, m, row, col, rows, cols) == NULL){
+        free(view);
+        return NULL;
+    }
+    return view;
+}
+
+int MATRIX_GENERIC_FN(Overlaps)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    if(m1 == NULL || m2 == NULL || m1->rows == 0 || m1->cols == 0 || m2->rows == 0 || m2->cols == 0){
+        return 0;
+    }
+    // Compare the address ranges from the first to one past the last element
+    const MATRIX_GENERIC_TYPE* end1 = m1->data + MATRIX_ADDR(m1, m1->rows - 1, m1->cols);
+    const MATRIX_GENERIC_TYPE* end2 = m2->data + MATRIX_ADDR(m2, m2->rows - 1, m2->cols);
+    return m1->data < end2 && m2->data < end1;
+}
+
+MATRIX_GENERIC_TYPE MATRIX_GENERIC_FN(GetValue)(MATRIX_GENERIC_MATRIX* m, int i, int j){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return -1;
+    }
+    // Check if index is positive
+    if(i < 0 || j < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return -1;
+    }
+    // Check if index matches the matrix dimensions
+    if(i >= m->rows || j >= m->cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return -1;
+    }
+    return m->data[MATRIX_ADDR(m, i, j)];
+}
+
+void MATRIX_GENERIC_FN(SetValue)(MATRIX_GENERIC_MATRIX* m, int i, int j, MATRIX_GENERIC_TYPE value){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return;
+    }
+    // Check if index is positive
+    if(i < 0 || j < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return;
+    }
+    // Check if index matches the matrix dimensions
+    if(i >= m->rows || j >= m->cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return;
+    }
+    m->data[MATRIX_ADDR(m, i, j)] = value;
+    return;
+}
+
+void MATRIX_GENERIC_FN(Print)(MATRIX_GENERIC_MATRIX* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return;
+    }
+    fprintf(stdout, "\n");
+    for(int i = 0; i < m->rows; i++){
+        fprintf(stdout, "[ ");
+        for(int j = 0; j < m->cols; j++){
+            MATRIX_GENERIC_PRINT(m->data[MATRIX_ADDR(m, i, j)]);
+        }
+        fprintf(stdout, "]\n");
+    }
+}
+
+/*
+    Static helper checking that dst has the given dimensions and is either
+    exactly the operand m or does not share memory with it (m may be NULL).
+    Prints an error message and returns 0 otherwise.
+*/
+static int MATRIX_GENERIC_FN(CheckDestination)(MATRIX_GENERIC_MATRIX* dst, int rows, int cols, MATRIX_GENERIC_MATRIX* m){
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return 0;
+    }
+    if(dst->rows != rows || dst->cols != cols){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return 0;
+    }
+    if(m != NULL && MATRIX_GENERIC_FN(Overlaps)(dst, m) && (dst->data != m->data || dst->stride != m->stride)){
+        fprintf(stderr, "Destination partially overlaps an operand.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Element-wise loops over one row. Results may be written in place;
+    the loops are simple enough for the compiler to vectorize.
+*/
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(RowAdd)(int n, const MATRIX_GENERIC_TYPE* a, const MATRIX_GENERIC_TYPE* b, MATRIX_GENERIC_TYPE* c){
+    for(int j = 0; j < n; j++){
+        c[j] = a[j] + b[j];
+    }
+}
+
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(RowSub)(int n, const MATRIX_GENERIC_TYPE* a, const MATRIX_GENERIC_TYPE* b, MATRIX_GENERIC_TYPE* c){
+    for(int j = 0; j < n; j++){
+        c[j] = a[j] - b[j];
+    }
+}
+
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(RowAddScalar)(int n, const MATRIX_GENERIC_TYPE* a, MATRIX_GENERIC_TYPE s, MATRIX_GENERIC_TYPE* c){
+    for(int j = 0; j < n; j++){
+        c[j] = a[j] + s;
+    }
+}
+
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(RowSubScalar)(int n, const MATRIX_GENERIC_TYPE* a, MATRIX_GENERIC_TYPE s, MATRIX_GENERIC_TYPE* c){
+    for(int j = 0; j < n; j++){
+        c[j] = a[j] - s;
+    }
+}
+
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(RowMulScalar)(int n, const MATRIX_GENERIC_TYPE* a, MATRIX_GENERIC_TYPE s, MATRIX_GENERIC_TYPE* c){
+    for(int j = 0; j < n; j++){
+        c[j] = a[j] * s;
+    }
+}
+
+/*
+    Apply a binary row loop to whole matrices of equal dimensions.
+*/
+static MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(ApplyBinary)(void (*fn)(int, const MATRIX_GENERIC_TYPE*, const MATRIX_GENERIC_TYPE*, MATRIX_GENERIC_TYPE*),
+                                                            MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->cols || m1->rows != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(!MATRIX_GENERIC_FN(CheckDestination)(dst, m1->rows, m1->cols, m1) || !MATRIX_GENERIC_FN(CheckDestination)(dst, m1->rows, m1->cols, m2)){
+        return NULL;
+    }
+    for(int i = 0; i < dst->rows; i++){
+        fn(dst->cols, m1->data + MATRIX_ADDR(m1, i, 0), m2->data + MATRIX_ADDR(m2, i, 0), dst->data + MATRIX_ADDR(dst, i, 0));
+    }
+    return dst;
+}
+
+/*
+    Apply a scalar row loop to a whole matrix.
+*/
+static MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(ApplyScalar)(void (*fn)(int, const MATRIX_GENERIC_TYPE*, MATRIX_GENERIC_TYPE, MATRIX_GENERIC_TYPE*),
+                                                            MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    if(!MATRIX_GENERIC_FN(CheckDestination)(dst, m1->rows, m1->cols, m1)){
+        return NULL;
+    }
+    for(int i = 0; i < dst->rows; i++){
+        fn(dst->cols, m1->data + MATRIX_ADDR(m1, i, 0), value, dst->data + MATRIX_ADDR(dst, i, 0));
+    }
+    return dst;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    return MATRIX_GENERIC_FN(ApplyBinary)(MATRIX_GENERIC_FN(RowAdd), dst, m1, m2);
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    return MATRIX_GENERIC_FN(ApplyBinary)(MATRIX_GENERIC_FN(RowSub), dst, m1, m2);
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    return MATRIX_GENERIC_FN(ApplyScalar)(MATRIX_GENERIC_FN(RowAddScalar), dst, m1, value);
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    return MATRIX_GENERIC_FN(ApplyScalar)(MATRIX_GENERIC_FN(RowSubScalar), dst, m1, value);
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulScalarInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    return MATRIX_GENERIC_FN(ApplyScalar)(MATRIX_GENERIC_FN(RowMulScalar), dst, m1, value);
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Add)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
+    if(MATRIX_GENERIC_FN(AddInto)(result, m1, m2) == NULL){
+        MATRIX_GENERIC_FN(Delete)(result);
+        return NULL;
+    }
+    return result;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Sub)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
+    if(MATRIX_GENERIC_FN(SubInto)(result, m1, m2) == NULL){
+        MATRIX_GENERIC_FN(Delete)(result);
+        return NULL;
+    }
+    return result;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(AddScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
+    MATRIX_GENERIC_FN(AddScalarInto)(result, m1, value);
+    return result;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(SubScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
+    MATRIX_GENERIC_FN(SubScalarInto)(result, m1, value);
+    return result;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulScalar)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_TYPE value){
+    // Check if matrix exists (is not null)
+    if(m1 == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m1->cols, MATRIX_CREATE_UNINITIALIZED);
+    MATRIX_GENERIC_FN(MulScalarInto)(result, m1, value);
+    return result;
+}
+
+/*
+    Arguments shared by the row tasks of one product.
+*/
+typedef struct {
+    MATRIX_GENERIC_MATRIX* dst;
+    MATRIX_GENERIC_MATRIX* m1;
+    MATRIX_GENERIC_MATRIX* m2;
+} MATRIX_GENERIC_FN(MulStep);
+
+/*
+    Compute the rows [begin, end) of dst = m1 * m2, MATRIX_TYPED_NC columns
+    at a time so the panel of m2 is reused from cache by every row.
+    Products are accumulated in MATRIX_GENERIC_ACC.
+*/
+MATRIX_VECTORIZE static void MATRIX_GENERIC_FN(MulTask)(void* arg, int begin, int end){
+    MATRIX_GENERIC_FN(MulStep)* step = arg;
+    MATRIX_GENERIC_MATRIX* dst = step->dst;
+    MATRIX_GENERIC_MATRIX* m1 = step->m1;
+    MATRIX_GENERIC_MATRIX* m2 = step->m2;
+    MATRIX_GENERIC_ACC acc[MATRIX_TYPED_NC];
+
+    for(int jc = 0; jc < dst->cols; jc += MATRIX_TYPED_NC){
+        int nc = dst->cols - jc < MATRIX_TYPED_NC ? dst->cols - jc : MATRIX_TYPED_NC;
+        for(int i = begin; i < end; i++){
+            const MATRIX_GENERIC_TYPE* ai = m1->data + MATRIX_ADDR(m1, i, 0);
+            for(int j = 0; j < nc; j++){
+                acc[j] = 0;
+            }
+            for(int p = 0; p < m1->cols; p++){
+                MATRIX_GENERIC_ACC aip = ai[p];
+                const MATRIX_GENERIC_TYPE* bp = m2->data + MATRIX_ADDR(m2, p, jc);
+                for(int j = 0; j < nc; j++){
+                    acc[j] += aip * bp[j];
+                }
+            }
+            MATRIX_GENERIC_TYPE* ci = dst->data + MATRIX_ADDR(dst, i, jc);
+            for(int j = 0; j < nc; j++){
+                ci[j] = (MATRIX_GENERIC_TYPE)acc[j];
+            }
+        }
+    }
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(MulInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(!MATRIX_GENERIC_FN(CheckDestination)(dst, m1->rows, m2->cols, NULL)){
+        return NULL;
+    }
+    // The product reads m1 and m2 while writing dst, so they cannot share memory.
+    if(MATRIX_GENERIC_FN(Overlaps)(dst, m1) || MATRIX_GENERIC_FN(Overlaps)(dst, m2)){
+        fprintf(stderr, "Destination of a matrix product cannot be one of its operands.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_FN(MulStep) step = {dst, m1, m2};
+    if((long long)m1->rows * m1->cols * m2->cols < MATRIX_TYPED_PARALLEL_THRESHOLD){
+        MATRIX_GENERIC_FN(MulTask)(&step, 0, m1->rows);
+    }
+    else{
+        matrixParallelFor(m1->rows, 16, MATRIX_GENERIC_FN(MulTask), &step);
+    }
+    return dst;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Mul)(MATRIX_GENERIC_MATRIX* m1, MATRIX_GENERIC_MATRIX* m2){
+    // Check if matrices exist (are not null)
+    if(m1 == NULL || m2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(m1->cols != m2->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m1->rows, m2->cols, MATRIX_CREATE_UNINITIALIZED);
+    MATRIX_GENERIC_FN(MulInto)(result, m1, m2);
+    return result;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(TransposeInto)(MATRIX_GENERIC_MATRIX* dst, MATRIX_GENERIC_MATRIX* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    if(!MATRIX_GENERIC_FN(CheckDestination)(dst, m->cols, m->rows, NULL)){
+        return NULL;
+    }
+    // Every element is read from another position, so the operand cannot be overwritten.
+    if(MATRIX_GENERIC_FN(Overlaps)(dst, m)){
+        fprintf(stderr, "Destination of a transpose cannot be its operand.\n");
+        return NULL;
+    }
+    // Copy tile by tile, so both the source and the destination stay in cache
+    for(int ii = 0; ii < m->rows; ii += MATRIX_TRANSPOSE_BLOCK){
+        int iEnd = m->rows - ii < MATRIX_TRANSPOSE_BLOCK ? m->rows : ii + MATRIX_TRANSPOSE_BLOCK;
+        for(int jj = 0; jj < m->cols; jj += MATRIX_TRANSPOSE_BLOCK){
+            int jEnd = m->cols - jj < MATRIX_TRANSPOSE_BLOCK ? m->cols : jj + MATRIX_TRANSPOSE_BLOCK;
+            for(int i = ii; i < iEnd; i++){
+                for(int j = jj; j < jEnd; j++){
+                    dst->data[MATRIX_ADDR(dst, j, i)] = m->data[MATRIX_ADDR(m, i, j)];
+                }
+            }
+        }
+    }
+    return dst;
+}
+
+MATRIX_GENERIC_MATRIX* MATRIX_GENERIC_FN(Transpose)(MATRIX_GENERIC_MATRIX* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    MATRIX_GENERIC_MATRIX* result = MATRIX_GENERIC_FN(CreateWith)(m->cols, m->rows, MATRIX_CREATE_UNINITIALIZED);
+    MATRIX_GENERIC_FN(TransposeInto)(result, m);
+    return result;
+}
@@ -0,0 +1,844 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "matrix.h"
+#include "matrix_io.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Header of a mapped matrix. The matrix comes first, so a pointer to it
+    is also a pointer to the whole structure.
+*/
+typedef struct {
+    matrix m;
+    void* base;     /* Start of the mapping */
+    size_t length;  /* Length of the mapping in bytes */
+} mappedMatrix;
+
+/*
+    Hash n consecutive elements into the four checksum lanes; k is the index
+    of the first one in the row-by-row sequence. Element k goes to lane k % 4,
+    so the four multiplication chains run in parallel.
+*/
+static void checksumUpdate(uint64_t lanes[4], size_t k, const double* x, size_t n){
+    for(size_t j = 0; j < n; j++, k++){
+        uint64_t word;
+        memcpy(&word, x + j, sizeof(word));
+        lanes[k & 3] = (lanes[k & 3] ^ word) * FNV_PRIME;
+    }
+}
+
+static uint64_t checksumFinish(const uint64_t lanes[4]){
+    uint64_t hash = FNV_OFFSET;
+    for(int l = 0; l < 4; l++){
+        hash = (hash ^ lanes[l]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t matrixChecksum(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return 0;
+    }
+    // Row padding is skipped
+    uint64_t lanes[4] = {FNV_OFFSET, FNV_OFFSET, FNV_OFFSET, FNV_OFFSET};
+    for(int i = 0; i < m->rows; i++){
+        checksumUpdate(lanes, (size_t)i * m->cols, m->data + MATRIX_ADDR(m, i, 0), m->cols);
+    }
+    return checksumFinish(lanes);
+}
+
+/*
+    Static helper checking that a header describes a valid matrix file of
+    `size` bytes.
+    Prints an error message and returns 0 if it does not.
+*/
+static int checkHeader(const matrixFileHeader* h, const char* path, uint64_t size){
+    if(memcmp(h->magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC)) != 0 || h->version != MATRIX_FILE_VERSION){
+        fprintf(stderr, "%s is not a matrix file of a supported version.\n", path);
+        return 0;
+    }
+    if(h->type != MATRIX_FILE_FLOAT64){
+        fprintf(stderr, "%s has an unsupported element type.\n", path);
+        return 0;
+    }
+    if(h->rows > INT32_MAX || h->cols > INT32_MAX || h->stride > INT32_MAX || h->stride < h->cols || h->dataOffset < sizeof(matrixFileHeader)){
+        fprintf(stderr, "%s has an invalid header.\n", path);
+        return 0;
+    }
+    if(size < h->dataOffset || (h->stride > 0 && (size - h->dataOffset) / sizeof(double) / h->stride < h->rows)){
+        fprintf(stderr, "%s is truncated.\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+int matrixSave(matrix* m, const char* path){
+    // Check if matrix and path exist (are not null)
+    if(m == NULL || path == NULL){
+        fprintf(stderr, "Matrix or path does not exist.\n");
+        return -1;
+    }
+    // The checksum goes into the header, so it is computed before anything is written
+    matrixFileHeader h = {MATRIX_FILE_MAGIC, MATRIX_FILE_VERSION, MATRIX_FILE_FLOAT64,
+                          (uint64_t)m->rows, (uint64_t)m->cols, (uint64_t)m->cols,
+                          sizeof(matrixFileHeader), matrixChecksum(m), 0};
+    FILE* f = fopen(path, "wb");
+    if(f == NULL){
+        fprintf(stderr, "Cannot open %s for writing.\n", path);
+        return -1;
+    }
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    // Contiguous matrices are written at once, others row by row
+    if(m->stride == m->cols || m->rows <= 1){
+        size_t count = (size_t)m->rows * m->cols;
+        ok = ok && fwrite(m->data, sizeof(double), count, f) == count;
+    }
+    else{
+        for(int i = 0; ok && i < m->rows; i++){
+            ok = fwrite(m->data + MATRIX_ADDR(m, i, 0), sizeof(double), m->cols, f) == (size_t)m->cols;
+        }
+    }
+    // Closing flushes the buffer, so its result matters as well
+    if(fclose(f) != 0 || !ok){
+        fprintf(stderr, "Cannot write %s.\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+matrix* matrixLoad(const char* path){
+    // Check if path exists (is not null)
+    if(path == NULL){
+        fprintf(stderr, "Path does not exist.\n");
+        return NULL;
+    }
+    FILE* f = fopen(path, "rb");
+    if(f == NULL){
+        fprintf(stderr, "Cannot open %s for reading.\n", path);
+        return NULL;
+    }
+    // The header is checked against the file size before the matrix is allocated
+    matrixFileHeader h;
+    struct stat st;
+    if(fstat(fileno(f), &st) != 0 || fread(&h, sizeof(h), 1, f) != 1 || !checkHeader(&h, path, (uint64_t)st.st_size) ||
+       fseek(f, (long)h.dataOffset, SEEK_SET) != 0){
+        if(!ferror(f)){
+            fprintf(stderr, "Cannot read %s.\n", path);
+        }
+        fclose(f);
+        return NULL;
+    }
+    // Every element is read below, so the matrix is not zeroed
+    matrix* m = matrixCreateWith((int)h.rows, (int)h.cols, MATRIX_CREATE_UNINITIALIZED);
+    int ok = 1;
+    for(int i = 0; ok && i < m->rows; i++){
+        ok = fread(m->data + MATRIX_ADDR(m, i, 0), sizeof(double), m->cols, f) == (size_t)m->cols;
+        // Skip the padding of the row
+        if(ok && h.stride > h.cols){
+            ok = fseek(f, (long)((h.stride - h.cols) * sizeof(double)), SEEK_CUR) == 0;
+        }
+    }
+    fclose(f);
+    if(!ok){
+        fprintf(stderr, "%s is truncated.\n", path);
+        matrixDelete(m);
+        return NULL;
+    }
+    if(matrixChecksum(m) != h.checksum){
+        fprintf(stderr, "Checksum of %s does not match.\n", path);
+        matrixDelete(m);
+        return NULL;
+    }
+    return m;
+}
+
+matrix* matrixMap(const char* path, int verify){
+    // Check if path exists (is not null)
+    if(path == NULL){
+        fprintf(stderr, "Path does not exist.\n");
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        fprintf(stderr, "Cannot open %s for reading.\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(matrixFileHeader)){
+        fprintf(stderr, "%s is not a matrix file of a supported version.\n", path);
+        close(fd);
+        return NULL;
+    }
+    // The mapping stays valid after the descriptor is closed
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED){
+        fprintf(stderr, "Cannot map %s.\n", path);
+        return NULL;
+    }
+    const matrixFileHeader* h = base;
+    if(!checkHeader(h, path, (uint64_t)st.st_size) || h->dataOffset % sizeof(double) != 0){
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    mappedMatrix* mapped = malloc(sizeof(mappedMatrix));
+    if(mapped == NULL){
+        allocationFailure();
+    }
+    mapped->base = base;
+    mapped->length = (size_t)st.st_size;
+    // The matrix points into the mapping, which it does not own like a view
+    matrix* m = &mapped->m;
+    m->rows = (int)h->rows;
+    m->cols = (int)h->cols;
+    m->stride = (int)h->stride;
+    m->ownsData = 0;
+    m->data = (double*)((char*)base + h->dataOffset);
+    if(verify && matrixChecksum(m) != h->checksum){
+        fprintf(stderr, "Checksum of %s does not match.\n", path);
+        matrixUnmap(m);
+        return NULL;
+    }
+    return m;
+}
+
+void matrixUnmap(matrix* m){
+    // Unmap the file and free the header if the matrix exists (non-null pointer).
+    if(m != NULL){
+        mappedMatrix* mapped = (mappedMatrix*)m;
+        munmap(mapped->base, mapped->length);
+        free(mapped);
+    }
+    return;
+}
+
+/*
+    Powers of ten that are exact in double precision.
+*/
+static const double exactPowersOf10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define IS_DIGIT(c) ((unsigned)((c) - '0') < 10)
+#define IS_BLANK(c) ((c) == ' ' || (c) == '\t' || (c) == '\r')
+
+/*
+    Parse a number with strtod, for the inputs the fast path cannot round
+    correctly and for "nan" and "inf". The token is copied, because the
+    mapped text is not terminated. Returns the end of the number, or NULL.
+*/
+static const char* parseNumberSlow(const char* p, const char* end, char delimiter, double* value){
+    char token[64];
+    size_t n = 0;
+    while(p + n < end && p[n] != delimiter && !IS_BLANK(p[n]) && p[n] != '\n'){
+        if(n == sizeof(token) - 1){
+            return NULL;
+        }
+        token[n] = p[n];
+        n++;
+    }
+    token[n] = '\0';
+    char* stop;
+    *value = strtod(token, &stop);
+    return stop == token ? NULL : p + (stop - token);
+}
+
+/*
+    Parse a decimal number starting at p. Up to 19 significant digits are
+    collected into an integer; when it fits in 53 bits and the decimal
+    exponent is at most 22, one exact multiplication or division by a power
+    of ten gives the correctly rounded result. Other inputs go to strtod.
+    Returns the end of the number, or NULL if there is none.
+*/
+static const char* parseNumber(const char* p, const char* end, char delimiter, double* value){
+    const char* start = p;
+    int negative = 0;
+    if(p < end && (*p == '-' || *p == '+')){
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    int exact = 1;
+    const char* first = p;
+    for(; p < end && IS_DIGIT(*p); p++){
+        if(digits < 19){
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+        }
+        else{
+            exponent++;
+            exact = 0;
+        }
+    }
+    if(p < end && *p == '.'){
+        p++;
+        for(; p < end && IS_DIGIT(*p); p++){
+            if(digits < 19){
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+            else if(*p != '0'){
+                exact = 0;
+            }
+        }
+    }
+    // No digits at all: "nan", "inf" or not a number
+    if(p == first || (p == first + 1 && *first == '.')){
+        return parseNumberSlow(start, end, delimiter, value);
+    }
+    if(p < end && (*p == 'e' || *p == 'E')){
+        const char* q = p + 1;
+        int expNegative = 0;
+        if(q < end && (*q == '-' || *q == '+')){
+            expNegative = *q == '-';
+            q++;
+        }
+        if(q == end || !IS_DIGIT(*q)){
+            return parseNumberSlow(start, end, delimiter, value);
+        }
+        int e = 0;
+        for(; q < end && IS_DIGIT(*q); q++){
+            if(e < 100000){
+                e = e * 10 + (*q - '0');
+            }
+        }
+        exponent += expNegative ? -e : e;
+        p = q;
+    }
+    if(!exact || mantissa > (1ULL << 53) || exponent < -22 || exponent > 22){
+        return parseNumberSlow(start, end, delimiter, value);
+    }
+    double v = (double)mantissa;
+    v = exponent < 0 ? v / exactPowersOf10[-exponent] : v * exactPowersOf10[exponent];
+    *value = negative ? -v : v;
+    return p;
+}
+
+/*
+    Static helper checking if the line [p, end) holds only blanks.
+*/
+static int isBlankLine(const char* p, const char* end){
+    while(p < end && IS_BLANK(*p)){
+        p++;
+    }
+    return p == end;
+}
+
+/*
+    Blanks around a value are skipped, except the delimiter itself. When the
+    delimiter is a space, a run of blanks separates two values.
+*/
+#define IS_PAD(c, delimiter) (IS_BLANK(c) && ((c) != (delimiter) || (delimiter) == ' '))
+
+/*
+    Parse the values of the line [p, end) into row, storing at most `cols` of them.
+    Returns the number of values on the line (0 for a blank line), or -1 if it is malformed.
+*/
+static int parseLine(const char* p, const char* end, char delimiter, double* row, int cols){
+    if(isBlankLine(p, end)){
+        return 0;
+    }
+    for(int j = 0;; j++){
+        double v;
+        while(p < end && IS_PAD(*p, delimiter)){
+            p++;
+        }
+        p = parseNumber(p, end, delimiter, &v);
+        if(p == NULL){
+            return -1;
+        }
+        if(j < cols){
+            row[j] = v;
+        }
+        const char* last = p;
+        while(p < end && IS_PAD(*p, delimiter)){
+            p++;
+        }
+        if(p == end){
+            return j + 1;
+        }
+        // The blanks skipped after the value were the separator
+        if(delimiter == ' ' && p > last){
+            continue;
+        }
+        if(*p != delimiter){
+            return -1;
+        }
+        p++;
+    }
+}
+
+/*
+    Return the end of the line starting at p (its '\n', or end).
+*/
+static const char* lineEnd(const char* p, const char* end){
+    const char* n = memchr(p, '\n', (size_t)(end - p));
+    return n == NULL ? end : n;
+}
+
+/*
+    Bytes of text parsed per task. Chunk boundaries are moved to the next line start.
+*/
+#ifndef MATRIX_CSV_CHUNK
+#define MATRIX_CSV_CHUNK (1024 * 1024)
+#endif
+
+/*
+    Arguments shared by the tasks of a text load. Chunk c covers the lines
+    in [bounds[c], bounds[c + 1]) and fills the rows from firstRow[c].
+*/
+typedef struct {
+    const char** bounds;
+    int* firstRow;      /* Number of rows per chunk in the first pass */
+    int* badRow;        /* First malformed row of every chunk, or -1 */
+    matrix* m;
+    char delimiter;
+} csvLoad;
+
+static void csvCountTask(void* arg, int begin, int end){
+    csvLoad* load = arg;
+    for(int c = begin; c < end; c++){
+        int rows = 0;
+        for(const char* p = load->bounds[c]; p < load->bounds[c + 1];){
+            const char* e = lineEnd(p, load->bounds[c + 1]);
+            rows += !isBlankLine(p, e);
+            p = e < load->bounds[c + 1] ? e + 1 : e;
+        }
+        load->firstRow[c] = rows;
+    }
+}
+
+static void csvParseTask(void* arg, int begin, int end){
+    csvLoad* load = arg;
+    matrix* m = load->m;
+    for(int c = begin; c < end; c++){
+        int i = load->firstRow[c];
+        load->badRow[c] = -1;
+        for(const char* p = load->bounds[c]; p < load->bounds[c + 1];){
+            const char* e = lineEnd(p, load->bounds[c + 1]);
+            if(!isBlankLine(p, e)){
+                if(parseLine(p, e, load->delimiter, m->data + MATRIX_ADDR(m, i, 0), m->cols) != m->cols){
+                    load->badRow[c] = i;
+                    break;
+                }
+                i++;
+            }
+            p = e < load->bounds[c + 1] ? e + 1 : e;
+        }
+    }
+}
+
+matrix* matrixLoadCsv(const char* path, char delimiter, int skipLines){
+    // Check if path exists (is not null)
+    if(path == NULL){
+        fprintf(stderr, "Path does not exist.\n");
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if(fd < 0){
+        fprintf(stderr, "Cannot open %s for reading.\n", path);
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0){
+        fprintf(stderr, "Cannot read %s.\n", path);
+        close(fd);
+        return NULL;
+    }
+    size_t length = (size_t)st.st_size;
+    // An empty file cannot be mapped, and holds an empty matrix
+    if(length == 0){
+        close(fd);
+        return matrixCreate(0, 0);
+    }
+    // The mapping stays valid after the descriptor is closed
+    void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED){
+        fprintf(stderr, "Cannot map %s.\n", path);
+        return NULL;
+    }
+    posix_madvise(base, length, POSIX_MADV_SEQUENTIAL);
+    const char* text = base;
+    const char* end = text + length;
+    for(int i = 0; i < skipLines && text < end; i++){
+        text = lineEnd(text, end);
+        text = text < end ? text + 1 : end;
+    }
+    // The first line with values gives the number of columns
+    int cols = 0;
+    for(const char* p = text; p < end && cols == 0;){
+        const char* e = lineEnd(p, end);
+        cols = parseLine(p, e, delimiter, NULL, 0);
+        if(cols < 0){
+            fprintf(stderr, "Row 1 of %s is malformed.\n", path);
+            munmap(base, length);
+            return NULL;
+        }
+        p = e < end ? e + 1 : end;
+    }
+
+    // Split the text into chunks that start at line boundaries
+    int chunks = (int)((size_t)(end - text) / MATRIX_CSV_CHUNK) + 1;
+    const char** bounds = malloc(sizeof(const char*) * (chunks + 1));
+    int* firstRow = malloc(sizeof(int) * chunks);
+    int* badRow = malloc(sizeof(int) * chunks);
+    if(bounds == NULL || firstRow == NULL || badRow == NULL){
+        allocationFailure();
+    }
+    bounds[0] = text;
+    for(int c = 1; c < chunks; c++){
+        const char* p = text + (size_t)c * MATRIX_CSV_CHUNK;
+        p = p < bounds[c - 1] ? bounds[c - 1] : p;
+        p = lineEnd(p, end);
+        bounds[c] = p < end ? p + 1 : end;
+    }
+    bounds[chunks] = end;
+
+    // Count the rows of every chunk, then turn the counts into the first row of every chunk
+    csvLoad load = {bounds, firstRow, badRow, NULL, delimiter};
+    matrixParallelFor(chunks, 1, csvCountTask, &load);
+    long long rows = 0;
+    for(int c = 0; c < chunks; c++){
+        int count = firstRow[c];
+        firstRow[c] = (int)rows;
+        rows += count;
+    }
+    matrix* m = NULL;
+    if(rows > 0x7fffffff){
+        fprintf(stderr, "%s has too many rows.\n", path);
+    }
+    else{
+        // Every element is parsed below, so the matrix is not zeroed
+        m = matrixCreateWith((int)rows, cols, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+        load.m = m;
+        matrixParallelFor(chunks, 1, csvParseTask, &load);
+        for(int c = 0; c < chunks; c++){
+            if(badRow[c] >= 0){
+                fprintf(stderr, "Row %d of %s is malformed or does not have %d values.\n", badRow[c] + 1, path, cols);
+                matrixDelete(m);
+                m = NULL;
+                break;
+            }
+        }
+    }
+    free(bounds);
+    free(firstRow);
+    free(badRow);
+    munmap(base, length);
+    return m;
+}
+
+/*
+    Memory budget of matrixMulFiles when none is given.
+*/
+#ifndef MATRIX_OUT_OF_CORE_MEMORY
+#define MATRIX_OUT_OF_CORE_MEMORY ((size_t)256 * 1024 * 1024)
+#endif
+
+/*
+    An open binary matrix file used by matrixMulFiles.
+*/
+typedef struct {
+    int fd;
+    const char* path;
+    matrixFileHeader h;
+} matrixFile;
+
+/*
+    Static helper opening a binary matrix file for reading and checking its header.
+    Prints an error message and returns 0 on error.
+*/
+static int fileOpen(matrixFile* f, const char* path){
+    f->path = path;
+    f->fd = open(path, O_RDONLY);
+    if(f->fd < 0){
+        fprintf(stderr, "Cannot open %s for reading.\n", path);
+        return 0;
+    }
+    struct stat st;
+    if(fstat(f->fd, &st) != 0 || pread(f->fd, &f->h, sizeof(f->h), 0) != (ssize_t)sizeof(f->h)){
+        fprintf(stderr, "%s is not a matrix file of a supported version.\n", path);
+        close(f->fd);
+        return 0;
+    }
+    if(!checkHeader(&f->h, path, (uint64_t)st.st_size)){
+        close(f->fd);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Read or write `bytes` contiguous bytes of a file at offset. Returns 0 on I/O error.
+*/
+static int fileRange(int fd, char* p, size_t bytes, off_t offset, int write){
+    while(bytes > 0){
+        ssize_t done = write ? pwrite(fd, p, bytes, offset) : pread(fd, p, bytes, offset);
+        if(done < 0 && errno == EINTR){
+            continue;
+        }
+        if(done <= 0){
+            return 0;
+        }
+        p += done;
+        bytes -= (size_t)done;
+        offset += done;
+    }
+    return 1;
+}
+
+/*
+    Read the tile of a file with top-left element (row, col) into a matrix of
+    the tile's dimensions, or write the matrix there. Returns 0 on I/O error.
+*/
+static int fileTransfer(matrixFile* f, matrix* tile, int row, int col, int write){
+    for(int i = 0; i < tile->rows; i++){
+        off_t offset = (off_t)(f->h.dataOffset + ((uint64_t)(row + i) * f->h.stride + (uint64_t)col) * sizeof(double));
+        if(!fileRange(f->fd, (char*)(tile->data + MATRIX_ADDR(tile, i, 0)), (size_t)tile->cols * sizeof(double), offset, write)){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+    One step of an out-of-core product: the tile of c at (i, j) accumulates
+    a(i, p) × b(p, j). Indices are in elements, not tiles.
+*/
+typedef struct {
+    int i;
+    int j;
+    int p;
+    int rows;
+    int cols;
+    int depth;
+} oocStep;
+
+/*
+    I/O done by the background thread while the current step is multiplied:
+    reading the operand tiles of the next step, and writing the result tile
+    finished by the previous one.
+*/
+typedef struct {
+    matrixFile* a;
+    matrixFile* b;
+    matrixFile* c;
+    int read;           /* Nonzero to read readStep into tileA and tileB */
+    oocStep readStep;
+    matrix* tileA;
+    matrix* tileB;
+    int write;          /* Nonzero to write tileC at writeStep */
+    oocStep writeStep;
+    matrix* tileC;
+    int ok;
+} oocTransfer;
+
+static void* oocTransferTask(void* arg){
+    oocTransfer* t = arg;
+    t->ok = 1;
+    if(t->write){
+        matrix view;
+        matrixViewInit(&view, t->tileC, 0, 0, t->writeStep.rows, t->writeStep.cols);
+        t->ok = fileTransfer(t->c, &view, t->writeStep.i, t->writeStep.j, 1);
+    }
+    if(t->read && t->ok){
+        matrix viewA, viewB;
+        matrixViewInit(&viewA, t->tileA, 0, 0, t->readStep.rows, t->readStep.depth);
+        matrixViewInit(&viewB, t->tileB, 0, 0, t->readStep.depth, t->readStep.cols);
+        t->ok = fileTransfer(t->a, &viewA, t->readStep.i, t->readStep.p, 0) &&
+                fileTransfer(t->b, &viewB, t->readStep.p, t->readStep.j, 0);
+    }
+    return NULL;
+}
+
+/*
+    Return step s of the product. The steps go over the tiles of c row by
+    row, and over the depth innermost, so every result tile is finished by
+    consecutive steps.
+*/
+static oocStep oocGetStep(long long s, int tile, int m, int n, int k){
+    int tilesN = (n + tile - 1) / tile;
+    int tilesK = (k + tile - 1) / tile;
+    oocStep step;
+    step.p = (int)(s % tilesK) * tile;
+    step.j = (int)(s / tilesK % tilesN) * tile;
+    step.i = (int)(s / tilesK / tilesN) * tile;
+    step.rows = m - step.i < tile ? m - step.i : tile;
+    step.cols = n - step.j < tile ? n - step.j : tile;
+    step.depth = k - step.p < tile ? k - step.p : tile;
+    return step;
+}
+
+/*
+    Static helper computing the checksum of a finished result file by
+    reading it back sequentially, one buffer of `capacity` elements at a time.
+    Returns 0 on I/O error.
+*/
+static int fileChecksum(matrixFile* f, double* buffer, size_t capacity, uint64_t* checksum){
+    uint64_t lanes[4] = {FNV_OFFSET, FNV_OFFSET, FNV_OFFSET, FNV_OFFSET};
+    uint64_t total = f->h.rows * f->h.cols;
+    posix_fadvise(f->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    for(uint64_t k = 0; k < total;){
+        size_t count = total - k < capacity ? (size_t)(total - k) : capacity;
+        off_t offset = (off_t)(f->h.dataOffset + k * sizeof(double));
+        if(!fileRange(f->fd, (char*)buffer, count * sizeof(double), offset, 0)){
+            return 0;
+        }
+        checksumUpdate(lanes, (size_t)k, buffer, count);
+        k += count;
+    }
+    *checksum = checksumFinish(lanes);
+    return 1;
+}
+
+int matrixMulFiles(const char* pathA, const char* pathB, const char* pathC, size_t memoryBytes){
+    // Check if paths exist (are not null)
+    if(pathA == NULL || pathB == NULL || pathC == NULL){
+        fprintf(stderr, "Path does not exist.\n");
+        return -1;
+    }
+    matrixFile a, b;
+    if(!fileOpen(&a, pathA)){
+        return -1;
+    }
+    if(!fileOpen(&b, pathB)){
+        close(a.fd);
+        return -1;
+    }
+    int m = (int)a.h.rows, k = (int)a.h.cols, n = (int)b.h.cols;
+    if((int)b.h.rows != k){
+        fprintf(stderr, "Incompatible matrix dimensions for multiplication.\n");
+        close(a.fd);
+        close(b.fd);
+        return -1;
+    }
+    // Truncating the result file must not destroy an operand
+    struct stat stA, stB, stC;
+    if(stat(pathC, &stC) == 0 && fstat(a.fd, &stA) == 0 && fstat(b.fd, &stB) == 0 &&
+       ((stC.st_dev == stA.st_dev && stC.st_ino == stA.st_ino) || (stC.st_dev == stB.st_dev && stC.st_ino == stB.st_ino))){
+        fprintf(stderr, "Result file must differ from the operand files.\n");
+        close(a.fd);
+        close(b.fd);
+        return -1;
+    }
+    matrixFile c = {open(pathC, O_RDWR | O_CREAT | O_TRUNC, 0644), pathC,
+                    {MATRIX_FILE_MAGIC, MATRIX_FILE_VERSION, MATRIX_FILE_FLOAT64,
+                     (uint64_t)m, (uint64_t)n, (uint64_t)n, sizeof(matrixFileHeader), 0, 0}};
+    // The file is sized up front; elements never written (k == 0) read as zeros
+    if(c.fd < 0 || ftruncate(c.fd, (off_t)(sizeof(matrixFileHeader) + (uint64_t)m * n * sizeof(double))) != 0){
+        fprintf(stderr, "Cannot open %s for writing.\n", pathC);
+        if(c.fd >= 0){
+            close(c.fd);
+        }
+        close(a.fd);
+        close(b.fd);
+        return -1;
+    }
+
+    // Two tiles of each operand and of the result must fit in the budget
+    size_t budget = memoryBytes > 0 ? memoryBytes : MATRIX_OUT_OF_CORE_MEMORY;
+    int tile = (int)sqrt((double)budget / (6 * sizeof(double)));
+    tile = tile >= 128 ? tile / 64 * 64 : tile >= 8 ? tile : 8;
+    int tileM = m < tile ? m : tile, tileN = n < tile ? n : tile, tileK = k < tile ? k : tile;
+    matrix* tileA[2];
+    matrix* tileB[2];
+    matrix* tileC[2];
+    for(int t = 0; t < 2; t++){
+        tileA[t] = matrixCreateWith(tileM, tileK, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+        tileB[t] = matrixCreateWith(tileK, tileN, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+        tileC[t] = matrixCreateWith(tileM, tileN, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+    }
+
+    long long tilesK = (k + tile - 1) / tile;
+    long long steps = (long long)((m + tile - 1) / tile) * ((n + tile - 1) / tile) * tilesK;
+    oocTransfer transfer = {&a, &b, &c, 1, {0}, tileA[0], tileB[0], 0, {0}, NULL, 1};
+    // The tiles of the first step are read up front
+    if(steps > 0){
+        transfer.readStep = oocGetStep(0, tile, m, n, k);
+        oocTransferTask(&transfer);
+    }
+    int ok = transfer.ok;
+    for(long long s = 0; ok && s < steps; s++){
+        oocStep step = oocGetStep(s, tile, m, n, k);
+        long long finished = s / tilesK;
+        // The next operand tiles are read, and the previous result tile written, in the background
+        transfer.read = s + 1 < steps;
+        if(transfer.read){
+            transfer.readStep = oocGetStep(s + 1, tile, m, n, k);
+            transfer.tileA = tileA[(s + 1) & 1];
+            transfer.tileB = tileB[(s + 1) & 1];
+        }
+        transfer.write = s > 0 && s % tilesK == 0;
+        if(transfer.write){
+            transfer.writeStep = oocGetStep(s - 1, tile, m, n, k);
+            transfer.tileC = tileC[(finished - 1) & 1];
+        }
+        pthread_t thread;
+        int background = (transfer.read || transfer.write) && pthread_create(&thread, NULL, oocTransferTask, &transfer) == 0;
+        matrixGemm(step.rows, step.cols, step.depth, 1.0, tileA[s & 1]->data, tileA[s & 1]->stride,
+                   tileB[s & 1]->data, tileB[s & 1]->stride, step.p == 0 ? 0.0 : 1.0,
+                   tileC[finished & 1]->data, tileC[finished & 1]->stride);
+        // Without a thread the transfer runs after the multiplication
+        if(background){
+            pthread_join(thread, NULL);
+        }
+        else if(transfer.read || transfer.write){
+            oocTransferTask(&transfer);
+        }
+        ok = transfer.ok;
+        if(ok && s + 1 == steps){
+            matrix view;
+            matrixViewInit(&view, tileC[finished & 1], 0, 0, step.rows, step.cols);
+            ok = fileTransfer(&c, &view, step.i, step.j, 1);
+        }
+    }
+    if(!ok){
+        fprintf(stderr, "Cannot transfer tiles between %s, %s and %s.\n", pathA, pathB, pathC);
+    }
+    else{
+        // The checksum is only known once every tile is written
+        size_t capacity = (size_t)tileM * tileC[0]->stride;
+        ok = fileChecksum(&c, tileC[0]->data, capacity, &c.h.checksum) &&
+             pwrite(c.fd, &c.h, sizeof(c.h), 0) == (ssize_t)sizeof(c.h);
+    }
+    if(close(c.fd) != 0 || !ok){
+        fprintf(stderr, "Cannot write %s.\n", pathC);
+        ok = 0;
+    }
+    close(a.fd);
+    close(b.fd);
+    for(int t = 0; t < 2; t++){
+        matrixDelete(tileA[t]);
+        matrixDelete(tileB[t]);
+        matrixDelete(tileC[t]);
+    }
+    return ok ? 0 : -1;
+}
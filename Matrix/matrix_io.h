@@ -0,0 +1,120 @@
+#ifndef MATRIX_IO_H
+#define MATRIX_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "matrix.h"
+
+/**
+ * Magic bytes at the start of every binary matrix file.
+ */
+#define MATRIX_FILE_MAGIC "MATRIXB"
+
+/**
+ * Version of the binary matrix file format.
+ */
+#define MATRIX_FILE_VERSION 1
+
+/**
+ * Element types of binary matrix files.
+ */
+typedef enum {
+    MATRIX_FILE_FLOAT64 = 1     /** IEEE 754 double precision */
+} matrixFileType;
+
+/**
+ * Header at the start of a binary matrix file, 64 bytes in native byte order.
+ * The elements follow at `dataOffset`, row by row with `stride` elements per
+ * row, so a memory-mapped file gives aligned rows without any copying.
+ */
+typedef struct {
+    char magic[8];          /** MATRIX_FILE_MAGIC, zero-terminated */
+    uint32_t version;       /** MATRIX_FILE_VERSION */
+    uint32_t type;          /** Element type (matrixFileType) */
+    uint64_t rows;          /** Number of rows */
+    uint64_t cols;          /** Number of columns */
+    uint64_t stride;        /** Number of elements between the starts of consecutive rows */
+    uint64_t dataOffset;    /** Offset of the first element from the start of the file */
+    uint64_t checksum;      /** Checksum of the elements (see matrixChecksum) */
+    uint64_t reserved;      /** Zero */
+} matrixFileHeader;
+
+/**
+ * Compute the checksum stored in binary matrix files: a 64-bit FNV-1a
+ * style hash over the elements taken row by row as 64-bit words, spread
+ * over four interleaved lanes that are hashed together at the end.
+ * Row padding is not included.
+ * @param m Pointer to the matrix
+ * @return Checksum of the elements, or 0 if m is NULL
+ */
+uint64_t matrixChecksum(matrix* m);
+
+/**
+ * Write a matrix to a binary file with sequential writes.
+ * The rows are stored without padding.
+ * @param m Pointer to the matrix (or view)
+ * @param path Path of the file to create or overwrite
+ * @return 0 on success, -1 on error
+ */
+int matrixSave(matrix* m, const char* path);
+
+/**
+ * Read a binary matrix file into a new matrix and verify its checksum.
+ * Function allocates memory for the matrix automatically.
+ * @param path Path of the file
+ * @return Pointer to the newly created matrix, or NULL if the file cannot be
+ *         read, is not a valid matrix file, or its checksum does not match
+ */
+matrix* matrixLoad(const char* path);
+
+/**
+ * Map a binary matrix file read-only into memory, without reading or copying
+ * its elements. Pages are loaded by the operating system on first access.
+ * The matrix may be used as an operand of every operation, but never as a
+ * destination, and must be released with matrixUnmap instead of matrixDelete.
+ * @param path Path of the file
+ * @param verify Nonzero to verify the checksum, which reads the whole file
+ * @return Pointer to the mapped matrix, or NULL on error
+ */
+matrix* matrixMap(const char* path, int verify);
+
+/**
+ * Unmap a matrix returned by matrixMap and free its header.
+ * @param m Pointer to the mapped matrix
+ */
+void matrixUnmap(matrix* m);
+
+/**
+ * Multiply two binary matrix files into a third one (c = a × b) without
+ * loading them, for operands larger than memory. Square tiles sized to the
+ * memory budget are read with positioned reads, multiplied with the same
+ * kernel as matrixMul and written back; a background thread reads the tiles
+ * of the next step and writes the previous result tile during each
+ * multiplication, so the run is bound by disk bandwidth when it is the bottleneck.
+ * The checksums of the operands are not verified (see matrixMap); the result
+ * file is read back once at the end to compute its own.
+ * @param pathA Path of the left operand file (m × k)
+ * @param pathB Path of the right operand file (k × n)
+ * @param pathC Path of the result file to create or overwrite, not one of the operands
+ * @param memoryBytes Memory for the tile buffers (two tiles of each operand and
+ *                    of the result), or 0 for a default of 256 MiB
+ * @return 0 on success, -1 on error
+ */
+int matrixMulFiles(const char* pathA, const char* pathB, const char* pathC, size_t memoryBytes);
+
+/**
+ * Read a text file of delimited numbers (e.g. CSV) into a new matrix, one line per row.
+ * The file is memory-mapped and split at line boundaries across the worker
+ * threads, which parse the numbers straight into the matrix. Spaces around
+ * values, blank lines and "\r\n" line endings are accepted; every row must
+ * have as many values as the first one.
+ * Function allocates memory for the matrix automatically.
+ * @param path Path of the file
+ * @param delimiter Character separating the values of a row, e.g. ',' or '\t';
+ *                  with ' ' any run of blanks separates two values
+ * @param skipLines Number of leading lines to ignore, e.g. 1 for a header line
+ * @return Pointer to the newly created matrix, or NULL if the file cannot be read or is malformed
+ */
+matrix* matrixLoadCsv(const char* path, char delimiter, int skipLines);
+
+#endif /* MATRIX_IO_H */
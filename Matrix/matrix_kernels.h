@@ -0,0 +1,61 @@
+#ifndef MATRIX_KERNELS_H
+#define MATRIX_KERNELS_H
+
+#include <stddef.h>
+
+/**
+ * x86 intrinsics are used by the kernels compiled with GCC or clang,
+ * unless disabled with -DMATRIX_NO_SIMD. Each kernel carries its own
+ * target attribute and is selected at runtime.
+ */
+#if !defined(MATRIX_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Attribute for functions whose loops are written for the auto-vectorizer,
+ * which GCC only enables by default from -O3.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#define MATRIX_VECTORIZE __attribute__((optimize("tree-vectorize")))
+#else
+#define MATRIX_VECTORIZE
+#endif
+
+/**
+ * Element-wise kernels working on n consecutive doubles.
+ * Every kernel allows c to alias a (and b), so results may be written in place.
+ */
+typedef void (*elementwiseBinaryFn)(size_t n, const double* a, const double* b, double* c);
+typedef void (*elementwiseScalarFn)(size_t n, const double* a, double s, double* c);
+typedef void (*elementwiseAxpyFn)(size_t n, const double* a, double s, const double* b, double* c);
+
+/**
+ * Table of element-wise kernels for one instruction set.
+ */
+typedef struct {
+    elementwiseBinaryFn add;        /** c = a + b */
+    elementwiseBinaryFn sub;        /** c = a - b */
+    elementwiseScalarFn addScalar;  /** c = a + s */
+    elementwiseScalarFn mulScalar;  /** c = a * s */
+    elementwiseBinaryFn mul;        /** c = a * b */
+    elementwiseAxpyFn axpy;         /** c = a * s + b */
+} elementwiseKernels;
+
+/**
+ * Return the element-wise kernels for the widest instruction set
+ * supported by the running CPU. The choice is made once.
+ * @return Pointer to the kernel table
+ */
+const elementwiseKernels* matrixElementwiseKernels();
+
+/**
+ * Compute c = alpha * a * b + beta * c on row-major arrays, for an m × k
+ * matrix a and a k × n matrix b with leading dimensions lda, ldb and ldc.
+ * Uses the same simple, blocked or multithreaded kernel as matrixMul.
+ * With beta == 0 the previous contents of c are ignored.
+ */
+void matrixGemm(int m, int n, int k, double alpha, const double* a, int lda, const double* b, int ldb, double beta, double* c, int ldc);
+
+#endif /* MATRIX_KERNELS_H */
@@ -0,0 +1,577 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "matrix.h"
+#include "matrix_vector.h"
+#include "matrix_reduce.h"
+#include "matrix_arena.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Number of elements reduced or mapped per task. Reductions always split
+    their input into blocks of this size, whatever the number of threads.
+*/
+#ifndef MATRIX_REDUCE_BLOCK
+#define MATRIX_REDUCE_BLOCK 16384
+#endif
+
+/*
+    Matrices with fewer elements than this are processed on the calling
+    thread, because waking the worker pool would cost more than it saves.
+*/
+#ifndef MATRIX_REDUCE_PARALLEL_THRESHOLD
+#define MATRIX_REDUCE_PARALLEL_THRESHOLD (256 * 1024)
+#endif
+
+/*
+    Number of column results updated at once by the column reductions.
+*/
+#ifndef MATRIX_REDUCE_COLUMN_BLOCK
+#define MATRIX_REDUCE_COLUMN_BLOCK 1024
+#endif
+
+#define REDUCE_OPS 6
+
+/*
+    Scalar step and combine operations of every reduction. Comparisons are
+    written so a NaN element x leaves the accumulator unchanged, matching
+    the AVX min/max instructions, which return their second operand then.
+*/
+#define SUM_STEP(acc, x) ((acc) + (x))
+#define ABS_SUM_STEP(acc, x) ((acc) + fabs(x))
+#define SQUARE_SUM_STEP(acc, x) ((acc) + (x) * (x))
+#define MIN_STEP(acc, x) ((x) < (acc) ? (x) : (acc))
+#define MAX_STEP(acc, x) ((x) > (acc) ? (x) : (acc))
+#define ABS_MAX_STEP(acc, x) (fabs(x) > (acc) ? fabs(x) : (acc))
+
+/* Initial value of every reduction, in the order of matrixReduceOp */
+static const double reduceInit[REDUCE_OPS] = {0.0, INFINITY, -INFINITY, 0.0, 0.0, 0.0};
+
+/*
+    Combine two partial results of a reduction.
+*/
+static double reduceCombine(matrixReduceOp op, double a, double b){
+    switch(op){
+        case MATRIX_REDUCE_MIN:
+            return MIN_STEP(a, b);
+        case MATRIX_REDUCE_MAX:
+        case MATRIX_REDUCE_ABS_MAX:
+            return MAX_STEP(a, b);
+        default:
+            return a + b;
+    }
+}
+
+/*
+    Generate a reduction kernel of n consecutive doubles for one instruction set.
+    Four independent accumulators of `width` lanes hide the latency of the
+    steps; they are combined lane by lane and the tail is handled by a scalar loop.
+*/
+#define DEFINE_REDUCE_KERNEL(name, target, vec, width, load, store, set1, vstep, vcombine, step, combine, init) \
+    target static double name(size_t n, const double* a){ \
+        vec acc0 = set1(init), acc1 = set1(init), acc2 = set1(init), acc3 = set1(init); \
+        size_t i = 0; \
+        for(; i + 4 * (width) <= n; i += 4 * (width)){ \
+            acc0 = vstep(acc0, load(a + i)); \
+            acc1 = vstep(acc1, load(a + i + (width))); \
+            acc2 = vstep(acc2, load(a + i + 2 * (width))); \
+            acc3 = vstep(acc3, load(a + i + 3 * (width))); \
+        } \
+        acc0 = vcombine(vcombine(acc0, acc1), vcombine(acc2, acc3)); \
+        double lanes[width]; \
+        store(lanes, acc0); \
+        double r = lanes[0]; \
+        for(int l = 1; l < (width); l++){ \
+            r = combine(r, lanes[l]); \
+        } \
+        for(; i < n; i++){ \
+            r = step(r, a[i]); \
+        } \
+        return r; \
+    }
+
+/* Scalar "vector" helpers so the portable fallback shares the generator. */
+#define SCALAR_LOAD(p) (*(p))
+#define SCALAR_STORE(p, v) (*(p) = (v))
+#define SCALAR_SET1(s) (s)
+
+DEFINE_REDUCE_KERNEL(reduceSumScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SUM_STEP, SUM_STEP, SUM_STEP, SUM_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceMinScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, MIN_STEP, MIN_STEP, MIN_STEP, MIN_STEP, INFINITY)
+DEFINE_REDUCE_KERNEL(reduceMaxScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, MAX_STEP, MAX_STEP, MAX_STEP, MAX_STEP, -INFINITY)
+DEFINE_REDUCE_KERNEL(reduceAbsSumScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, ABS_SUM_STEP, SUM_STEP, ABS_SUM_STEP, SUM_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceAbsMaxScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, ABS_MAX_STEP, MAX_STEP, ABS_MAX_STEP, MAX_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceSquareSumScalar, , double, 1, SCALAR_LOAD, SCALAR_STORE, SCALAR_SET1, SQUARE_SUM_STEP, SUM_STEP, SQUARE_SUM_STEP, SUM_STEP, 0.0)
+
+#ifdef MATRIX_X86_SIMD
+#define AVX_ABS(x) _mm256_andnot_pd(_mm256_set1_pd(-0.0), (x))
+#define AVX_SUM_STEP(acc, x) _mm256_add_pd((acc), (x))
+#define AVX_ABS_SUM_STEP(acc, x) _mm256_add_pd((acc), AVX_ABS(x))
+#define AVX_SQUARE_SUM_STEP(acc, x) _mm256_fmadd_pd((x), (x), (acc))
+#define AVX_MIN_STEP(acc, x) _mm256_min_pd((x), (acc))
+#define AVX_MAX_STEP(acc, x) _mm256_max_pd((x), (acc))
+#define AVX_ABS_MAX_STEP(acc, x) _mm256_max_pd(AVX_ABS(x), (acc))
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+DEFINE_REDUCE_KERNEL(reduceSumAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_SUM_STEP, AVX_SUM_STEP, SUM_STEP, SUM_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceMinAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_MIN_STEP, AVX_MIN_STEP, MIN_STEP, MIN_STEP, INFINITY)
+DEFINE_REDUCE_KERNEL(reduceMaxAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_MAX_STEP, AVX_MAX_STEP, MAX_STEP, MAX_STEP, -INFINITY)
+DEFINE_REDUCE_KERNEL(reduceAbsSumAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_ABS_SUM_STEP, AVX_SUM_STEP, ABS_SUM_STEP, SUM_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceAbsMaxAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_ABS_MAX_STEP, AVX_MAX_STEP, ABS_MAX_STEP, MAX_STEP, 0.0)
+DEFINE_REDUCE_KERNEL(reduceSquareSumAvx2, AVX2_TARGET, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                     AVX_SQUARE_SUM_STEP, AVX_SUM_STEP, SQUARE_SUM_STEP, SUM_STEP, 0.0)
+#endif
+
+typedef double (*reduceFn)(size_t n, const double* a);
+
+/*
+    Return the reduction kernels for the widest instruction set supported
+    by the running CPU, in the order of matrixReduceOp. The choice is made once.
+*/
+static const reduceFn* reduceKernels(){
+    static const reduceFn scalar[REDUCE_OPS] = {reduceSumScalar, reduceMinScalar, reduceMaxScalar,
+                                                reduceAbsSumScalar, reduceAbsMaxScalar, reduceSquareSumScalar};
+    static const reduceFn* selected = NULL;
+    if(selected != NULL){
+        return selected;
+    }
+    selected = scalar;
+#ifdef MATRIX_X86_SIMD
+    static const reduceFn avx2[REDUCE_OPS] = {reduceSumAvx2, reduceMinAvx2, reduceMaxAvx2,
+                                              reduceAbsSumAvx2, reduceAbsMaxAvx2, reduceSquareSumAvx2};
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        selected = avx2;
+    }
+#endif
+    return selected;
+}
+
+/*
+    Generate the column kernel of a reduction: acc[j] = step(acc[j], a[j]).
+    The loop has no dependency between elements and is left to the auto-vectorizer.
+*/
+#define DEFINE_COLUMN_KERNEL(name, step) \
+    MATRIX_VECTORIZE static void name(size_t n, const double* restrict a, double* restrict acc){ \
+        for(size_t j = 0; j < n; j++){ \
+            acc[j] = step(acc[j], a[j]); \
+        } \
+    }
+
+DEFINE_COLUMN_KERNEL(columnSum, SUM_STEP)
+DEFINE_COLUMN_KERNEL(columnMin, MIN_STEP)
+DEFINE_COLUMN_KERNEL(columnMax, MAX_STEP)
+DEFINE_COLUMN_KERNEL(columnAbsSum, ABS_SUM_STEP)
+DEFINE_COLUMN_KERNEL(columnAbsMax, ABS_MAX_STEP)
+DEFINE_COLUMN_KERNEL(columnSquareSum, SQUARE_SUM_STEP)
+
+typedef void (*columnFn)(size_t n, const double* a, double* acc);
+static const columnFn columnKernels[REDUCE_OPS] = {columnSum, columnMin, columnMax, columnAbsSum, columnAbsMax, columnSquareSum};
+
+/*
+    Static helper validating a matrix and a reduction.
+    Prints an error message and returns 0 if they are invalid.
+*/
+static int checkReduce(matrix* m, matrixReduceOp op){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return 0;
+    }
+    if((int)op < 0 || (int)op >= REDUCE_OPS){
+        fprintf(stderr, "Unknown reduction.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Arguments shared by the tasks of a reduction. A full reduction of a
+    contiguous matrix splits the flat data array into blocks of
+    MATRIX_REDUCE_BLOCK elements; otherwise every block is a group of
+    `blockRows` rows.
+*/
+typedef struct {
+    matrix* m;
+    matrixReduceOp op;
+    reduceFn kernel;
+    int contiguous;
+    int blockRows;
+    double* results;    /* One result per block, row or column */
+    int parts;          /* Row partitions of a column reduction */
+} reduceStep;
+
+static void reduceBlocksTask(void* arg, int begin, int end){
+    reduceStep* step = arg;
+    matrix* m = step->m;
+    for(int b = begin; b < end; b++){
+        if(step->contiguous){
+            size_t total = (size_t)m->rows * m->cols;
+            size_t first = (size_t)b * MATRIX_REDUCE_BLOCK;
+            size_t n = total - first < MATRIX_REDUCE_BLOCK ? total - first : MATRIX_REDUCE_BLOCK;
+            step->results[b] = step->kernel(n, m->data + first);
+            continue;
+        }
+        int i0 = b * step->blockRows;
+        int i1 = m->rows - i0 < step->blockRows ? m->rows : i0 + step->blockRows;
+        double r = reduceInit[step->op];
+        for(int i = i0; i < i1; i++){
+            r = reduceCombine(step->op, r, step->kernel(m->cols, m->data + MATRIX_ADDR(m, i, 0)));
+        }
+        step->results[b] = r;
+    }
+}
+
+/*
+    Run a reduction task over `count` items, on the worker pool for large matrices.
+*/
+static void reduceRun(matrixTaskFn fn, reduceStep* step, int count, int grain){
+    if((long long)step->m->rows * step->m->cols < MATRIX_REDUCE_PARALLEL_THRESHOLD){
+        fn(step, 0, count);
+    }
+    else{
+        matrixParallelFor(count, grain, fn, step);
+    }
+}
+
+double matrixReduce(matrix* m, matrixReduceOp op){
+    if(!checkReduce(m, op)){
+        return NAN;
+    }
+    if(m->rows == 0 || m->cols == 0){
+        return reduceInit[op];
+    }
+    reduceStep step = {m, op, reduceKernels()[op], m->stride == m->cols || m->rows == 1, 0, NULL, 0};
+    int blocks;
+    if(step.contiguous){
+        blocks = (int)(((size_t)m->rows * m->cols + MATRIX_REDUCE_BLOCK - 1) / MATRIX_REDUCE_BLOCK);
+    }
+    else{
+        step.blockRows = MATRIX_REDUCE_BLOCK / m->cols > 0 ? MATRIX_REDUCE_BLOCK / m->cols : 1;
+        blocks = (m->rows + step.blockRows - 1) / step.blockRows;
+    }
+    // The block results are combined in order, so the rounding never depends on the threads
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    step.results = matrixArenaAlloc(arena, sizeof(double) * blocks);
+    reduceRun(reduceBlocksTask, &step, blocks, 1);
+    double r = reduceInit[op];
+    for(int b = 0; b < blocks; b++){
+        r = reduceCombine(op, r, step.results[b]);
+    }
+    matrixArenaRelease(arena, mark);
+    return r;
+}
+
+static void reduceRowsTask(void* arg, int begin, int end){
+    reduceStep* step = arg;
+    matrix* m = step->m;
+    for(int i = begin; i < end; i++){
+        step->results[i] = step->kernel(m->cols, m->data + MATRIX_ADDR(m, i, 0));
+    }
+}
+
+vector* matrixReduceRowsInto(vector* dst, matrix* m, matrixReduceOp op){
+    if(!checkReduce(m, op)){
+        return NULL;
+    }
+    if(dst == NULL){
+        fprintf(stderr, "Destination vector does not exist.\n");
+        return NULL;
+    }
+    if(dst->size != m->rows){
+        fprintf(stderr, "Destination vector has incompatible dimensions.\n");
+        return NULL;
+    }
+    reduceStep step = {m, op, reduceKernels()[op], 0, 0, dst->data, 0};
+    reduceRun(reduceRowsTask, &step, m->rows, MATRIX_REDUCE_BLOCK / (m->cols > 0 ? m->cols : 1));
+    return dst;
+}
+
+vector* matrixReduceRows(matrix* m, matrixReduceOp op){
+    if(!checkReduce(m, op)){
+        return NULL;
+    }
+    vector* result = vectorCreate(m->rows);
+    matrixReduceRowsInto(result, m, op);
+    return result;
+}
+
+/*
+    Reduce the rows [i0, i1) of the columns [j0, j1) into acc, which holds j1 - j0 results.
+*/
+static void reduceColumns(reduceStep* step, int i0, int i1, int j0, int j1, double* acc){
+    matrix* m = step->m;
+    columnFn kernel = columnKernels[step->op];
+    for(int j = 0; j < j1 - j0; j++){
+        acc[j] = reduceInit[step->op];
+    }
+    for(int i = i0; i < i1; i++){
+        kernel(j1 - j0, m->data + MATRIX_ADDR(m, i, j0), acc);
+    }
+}
+
+static void reduceColumnBlocksTask(void* arg, int begin, int end){
+    reduceStep* step = arg;
+    int cols = step->m->cols;
+    for(int b = begin; b < end; b++){
+        int j0 = b * MATRIX_REDUCE_COLUMN_BLOCK;
+        int j1 = cols - j0 < MATRIX_REDUCE_COLUMN_BLOCK ? cols : j0 + MATRIX_REDUCE_COLUMN_BLOCK;
+        reduceColumns(step, 0, step->m->rows, j0, j1, step->results + j0);
+    }
+}
+
+static void reduceColumnPartitionsTask(void* arg, int begin, int end){
+    reduceStep* step = arg;
+    matrix* m = step->m;
+    for(int p = begin; p < end; p++){
+        int i0 = (int)((long long)m->rows * p / step->parts);
+        int i1 = (int)((long long)m->rows * (p + 1) / step->parts);
+        reduceColumns(step, i0, i1, 0, m->cols, step->results + (size_t)p * m->cols);
+    }
+}
+
+vector* matrixReduceColsInto(vector* dst, matrix* m, matrixReduceOp op){
+    if(!checkReduce(m, op)){
+        return NULL;
+    }
+    if(dst == NULL){
+        fprintf(stderr, "Destination vector does not exist.\n");
+        return NULL;
+    }
+    if(dst->size != m->cols){
+        fprintf(stderr, "Destination vector has incompatible dimensions.\n");
+        return NULL;
+    }
+    reduceStep step = {m, op, NULL, 0, 0, dst->data, 0};
+    int blocks = (m->cols + MATRIX_REDUCE_COLUMN_BLOCK - 1) / MATRIX_REDUCE_COLUMN_BLOCK;
+    int threads = matrixGetNumThreads();
+    if((long long)m->rows * m->cols < MATRIX_REDUCE_PARALLEL_THRESHOLD || threads == 1){
+        reduceColumnBlocksTask(&step, 0, blocks);
+        return dst;
+    }
+    // Wide matrices split the results into blocks, each reduced over all rows
+    if(blocks >= threads){
+        matrixParallelFor(blocks, 1, reduceColumnBlocksTask, &step);
+        return dst;
+    }
+    // Tall matrices split the rows, reduce them per partition and combine the partitions
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    step.parts = threads;
+    step.results = matrixArenaAlloc(arena, sizeof(double) * threads * m->cols);
+    matrixParallelFor(step.parts, 1, reduceColumnPartitionsTask, &step);
+    for(int j = 0; j < m->cols; j++){
+        double r = step.results[j];
+        for(int p = 1; p < step.parts; p++){
+            r = reduceCombine(op, r, step.results[(size_t)p * m->cols + j]);
+        }
+        dst->data[j] = r;
+    }
+    matrixArenaRelease(arena, mark);
+    return dst;
+}
+
+vector* matrixReduceCols(matrix* m, matrixReduceOp op){
+    if(!checkReduce(m, op)){
+        return NULL;
+    }
+    vector* result = vectorCreate(m->cols);
+    matrixReduceColsInto(result, m, op);
+    return result;
+}
+
+double matrixNorm(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NAN;
+    }
+    // The plain sum of squares is exact enough unless it overflowed or lost precision to underflow
+    double sum = matrixReduce(m, MATRIX_REDUCE_SQUARE_SUM);
+    if(isnan(sum) || (isfinite(sum) && sum >= DBL_MIN)){
+        return sqrt(sum);
+    }
+    // Otherwise scale the elements by the largest magnitude first
+    double scale = matrixReduce(m, MATRIX_REDUCE_ABS_MAX);
+    if(scale == 0 || isinf(scale)){
+        return scale;
+    }
+    sum = 0;
+    for(int i = 0; i < m->rows; i++){
+        const double* row = m->data + MATRIX_ADDR(m, i, 0);
+        for(int j = 0; j < m->cols; j++){
+            double t = row[j] / scale;
+            sum += t * t;
+        }
+    }
+    return scale * sqrt(sum);
+}
+
+/*
+    Find the first position of the extreme element selected by op (MIN or MAX).
+*/
+static int matrixArgExtreme(matrix* m, int* row, int* col, matrixReduceOp op){
+    // Check if matrix and outputs exist (are not null)
+    if(m == NULL || row == NULL || col == NULL){
+        fprintf(stderr, "Matrix or output index does not exist.\n");
+        return -1;
+    }
+    if(m->rows == 0 || m->cols == 0){
+        fprintf(stderr, "Matrix is empty.\n");
+        return -1;
+    }
+    // Reduce every row, pick the first row holding the extreme, then find it in that row
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    vector rows = {m->rows, matrixArenaAlloc(arena, sizeof(double) * m->rows)};
+    matrixReduceRowsInto(&rows, m, op);
+    int bestRow = 0;
+    for(int i = 1; i < m->rows; i++){
+        if(reduceCombine(op, rows.data[bestRow], rows.data[i]) != rows.data[bestRow]){
+            bestRow = i;
+        }
+    }
+    double best = rows.data[bestRow];
+    matrixArenaRelease(arena, mark);
+    const double* r = m->data + MATRIX_ADDR(m, bestRow, 0);
+    int bestCol = 0;
+    while(bestCol < m->cols && r[bestCol] != best){
+        bestCol++;
+    }
+    // A row of NaN only has no extreme element
+    *row = bestRow;
+    *col = bestCol < m->cols ? bestCol : 0;
+    return 0;
+}
+
+int matrixArgMax(matrix* m, int* row, int* col){
+    return matrixArgExtreme(m, row, col, MATRIX_REDUCE_MAX);
+}
+
+int matrixArgMin(matrix* m, int* row, int* col){
+    return matrixArgExtreme(m, row, col, MATRIX_REDUCE_MIN);
+}
+
+/*
+    Element-wise kernels of matrixApplyOpInto. c may alias a, so the loops
+    do not use restrict and the vectorizer checks the overlap at runtime.
+*/
+MATRIX_VECTORIZE static void applyAbs(size_t n, const double* a, double* c){
+    for(size_t i = 0; i < n; i++){
+        c[i] = fabs(a[i]);
+    }
+}
+
+static void applyExp(size_t n, const double* a, double* c){
+    for(size_t i = 0; i < n; i++){
+        c[i] = exp(a[i]);
+    }
+}
+
+MATRIX_VECTORIZE static void applyClamp(size_t n, const double* a, double* c, double lo, double hi){
+    for(size_t i = 0; i < n; i++){
+        double v = a[i] < lo ? lo : a[i];
+        c[i] = v > hi ? hi : v;
+    }
+}
+
+/*
+    Arguments shared by the tasks of an element-wise map. fn is NULL for a built-in op.
+*/
+typedef struct {
+    matrix* dst;
+    matrix* m;
+    double (*fn)(double);
+    matrixApplyOp op;
+    double lo;
+    double hi;
+} applyStep;
+
+static void applyTask(void* arg, int begin, int end){
+    applyStep* step = arg;
+    int n = step->m->cols;
+    for(int i = begin; i < end; i++){
+        const double* a = step->m->data + MATRIX_ADDR(step->m, i, 0);
+        double* c = step->dst->data + MATRIX_ADDR(step->dst, i, 0);
+        if(step->fn != NULL){
+            for(int j = 0; j < n; j++){
+                c[j] = step->fn(a[j]);
+            }
+            continue;
+        }
+        switch(step->op){
+            case MATRIX_APPLY_ABS:
+                applyAbs(n, a, c);
+                break;
+            case MATRIX_APPLY_EXP:
+                applyExp(n, a, c);
+                break;
+            case MATRIX_APPLY_CLAMP:
+                applyClamp(n, a, c, step->lo, step->hi);
+                break;
+        }
+    }
+}
+
+/*
+    Validate the operands of a map and run it, on the worker pool for large matrices.
+*/
+static matrix* applyRun(applyStep* step){
+    matrix* dst = step->dst;
+    matrix* m = step->m;
+    // Check if matrices exist (are not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return NULL;
+    }
+    if(dst->rows != m->rows || dst->cols != m->cols){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return NULL;
+    }
+    // In place is fine, a shifted overlap would read elements already written
+    if(matrixOverlaps(dst, m) && (dst->data != m->data || dst->stride != m->stride)){
+        fprintf(stderr, "Destination partially overlaps an operand.\n");
+        return NULL;
+    }
+    if((long long)m->rows * m->cols < MATRIX_REDUCE_PARALLEL_THRESHOLD){
+        applyTask(step, 0, m->rows);
+    }
+    else{
+        matrixParallelFor(m->rows, MATRIX_REDUCE_BLOCK / (m->cols > 0 ? m->cols : 1), applyTask, step);
+    }
+    return dst;
+}
+
+matrix* matrixApplyInto(matrix* dst, matrix* m, double (*fn)(double)){
+    // Check if function exists (is not null)
+    if(fn == NULL){
+        fprintf(stderr, "Function does not exist.\n");
+        return NULL;
+    }
+    applyStep step = {dst, m, fn, MATRIX_APPLY_ABS, 0, 0};
+    return applyRun(&step);
+}
+
+matrix* matrixApplyOpInto(matrix* dst, matrix* m, matrixApplyOp op, double lo, double hi){
+    if((int)op < MATRIX_APPLY_ABS || op > MATRIX_APPLY_CLAMP){
+        fprintf(stderr, "Unknown element-wise function.\n");
+        return NULL;
+    }
+    if(op == MATRIX_APPLY_CLAMP && !(lo <= hi)){
+        fprintf(stderr, "Lower bound is greater than upper bound.\n");
+        return NULL;
+    }
+    applyStep step = {dst, m, NULL, op, lo, hi};
+    return applyRun(&step);
+}
@@ -0,0 +1,128 @@
+#ifndef MATRIX_REDUCE_H
+#define MATRIX_REDUCE_H
+
+#include "matrix.h"
+#include "matrix_vector.h"
+
+/**
+ * Reductions over the elements of a matrix.
+ * MIN and MAX ignore NaN elements; the sums propagate them.
+ */
+typedef enum {
+    MATRIX_REDUCE_SUM,          /** Sum of the elements (0 for none) */
+    MATRIX_REDUCE_MIN,          /** Smallest element (+inf for none) */
+    MATRIX_REDUCE_MAX,          /** Largest element (-inf for none) */
+    MATRIX_REDUCE_ABS_SUM,      /** Sum of the magnitudes */
+    MATRIX_REDUCE_ABS_MAX,      /** Largest magnitude (0 for none) */
+    MATRIX_REDUCE_SQUARE_SUM    /** Sum of the squares */
+} matrixReduceOp;
+
+/**
+ * Built-in element-wise functions of matrixApplyOpInto.
+ */
+typedef enum {
+    MATRIX_APPLY_ABS,       /** |x| */
+    MATRIX_APPLY_EXP,       /** e^x */
+    MATRIX_APPLY_CLAMP      /** x limited to [lo, hi] */
+} matrixApplyOp;
+
+/**
+ * Reduce all elements of a matrix to one value.
+ * Large matrices are split into fixed blocks reduced by multiple threads,
+ * so the result does not depend on the number of threads.
+ * @param m Pointer to the matrix
+ * @param op Reduction
+ * @return The reduced value, or NAN on invalid arguments
+ */
+double matrixReduce(matrix* m, matrixReduceOp op);
+
+/**
+ * Reduce every row of a matrix into an existing vector.
+ * @param dst Pointer to the vector of m->rows elements
+ * @param m Pointer to the matrix
+ * @param op Reduction
+ * @return dst, or NULL if dimensions mismatch
+ */
+vector* matrixReduceRowsInto(vector* dst, matrix* m, matrixReduceOp op);
+
+/**
+ * Reduce every row of a matrix (e.g. row sums).
+ * Function allocates memory for the vector automatically.
+ * @param m Pointer to the matrix
+ * @param op Reduction
+ * @return Pointer to the vector of m->rows results, or NULL on invalid arguments
+ */
+vector* matrixReduceRows(matrix* m, matrixReduceOp op);
+
+/**
+ * Reduce every column of a matrix into an existing vector.
+ * The rows are streamed once, updating a block of results at a time.
+ * @param dst Pointer to the vector of m->cols elements
+ * @param m Pointer to the matrix
+ * @param op Reduction
+ * @return dst, or NULL if dimensions mismatch
+ */
+vector* matrixReduceColsInto(vector* dst, matrix* m, matrixReduceOp op);
+
+/**
+ * Reduce every column of a matrix (e.g. column sums).
+ * Function allocates memory for the vector automatically.
+ * @param m Pointer to the matrix
+ * @param op Reduction
+ * @return Pointer to the vector of m->cols results, or NULL on invalid arguments
+ */
+vector* matrixReduceCols(matrix* m, matrixReduceOp op);
+
+/**
+ * Compute the Frobenius norm of a matrix (square root of the sum of squared
+ * elements), without overflow or underflow for elements of extreme magnitude.
+ * @param m Pointer to the matrix
+ * @return The norm, or NAN if m is NULL
+ */
+double matrixNorm(matrix* m);
+
+/**
+ * Find the position of the largest element (the first one in row-major order on ties).
+ * NaN elements are ignored.
+ * @param m Pointer to the matrix
+ * @param row Output row index
+ * @param col Output column index
+ * @return 0 on success, -1 if the matrix is empty or arguments are invalid
+ */
+int matrixArgMax(matrix* m, int* row, int* col);
+
+/**
+ * Find the position of the smallest element (the first one in row-major order on ties).
+ * NaN elements are ignored.
+ * @param m Pointer to the matrix
+ * @param row Output row index
+ * @param col Output column index
+ * @return 0 on success, -1 if the matrix is empty or arguments are invalid
+ */
+int matrixArgMin(matrix* m, int* row, int* col);
+
+/**
+ * Apply a function to every element of a matrix into an existing matrix
+ * (dst[i][j] = fn(m[i][j])). dst may be m to work in place.
+ * Large matrices are processed by multiple threads, so fn must be thread-safe.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix
+ * @param fn Function applied to every element
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixApplyInto(matrix* dst, matrix* m, double (*fn)(double));
+
+/**
+ * Apply a built-in function to every element of a matrix into an existing
+ * matrix. The loops are vectorized where the function allows it.
+ * dst may be m to work in place.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix
+ * @param op Function applied to every element
+ * @param lo Lower bound of MATRIX_APPLY_CLAMP (ignored by the other functions)
+ * @param hi Upper bound of MATRIX_APPLY_CLAMP (ignored by the other functions)
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixApplyOpInto(matrix* dst, matrix* m, matrixApplyOp op, double lo, double hi);
+
+#endif /* MATRIX_REDUCE_H */
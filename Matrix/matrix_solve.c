@@ -0,0 +1,1060 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "matrix.h"
+#include "matrix_vector.h"
+#include "matrix_solve.h"
+#include "matrix_kernels.h"
+#include "matrix_arena.h"
+#include "thread_pool.h"
+
+/*
+    Number of rows handled per block by the Cholesky factorization and the
+    triangular solves. Inside a block the work is done row by row, and
+    everything outside of it is one GEMM per block.
+*/
+#ifndef MATRIX_SOLVE_BLOCK
+#define MATRIX_SOLVE_BLOCK 64
+#endif
+
+/*
+    Number of elements of Householder vectors transposed per GEMM when forming
+    Vᵀ * C in the QR factorization (narrow blocks of vectors get more rows),
+    and number of columns per task when that product is split by columns.
+*/
+#ifndef MATRIX_QR_CHUNK
+#define MATRIX_QR_CHUNK (256 * 64)
+#endif
+#define QR_COLUMN_BLOCK 256
+
+/*
+    Panels of at most this many columns are factorized without recursion, and
+    blocks of at most this many Householder vectors are applied by loops
+    streaming over the rows once, which beats GEMMs with such a small inner dimension.
+*/
+#ifndef MATRIX_QR_NARROW
+#define MATRIX_QR_NARROW 8
+#endif
+
+/*
+    Number of rows per task of the passes of the unblocked QR factorization of
+    narrow panels. Panels of up to this many rows are handled by the calling thread.
+*/
+#ifndef MATRIX_QR_ROWS
+#define MATRIX_QR_ROWS 16384
+#endif
+
+/*
+    Products Vᵀ * C with fewer multiply-adds than this are computed by the calling thread.
+*/
+#ifndef MATRIX_QR_PARALLEL_THRESHOLD
+#define MATRIX_QR_PARALLEL_THRESHOLD (1 << 22)
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Copy a (possibly strided) matrix into a new aligned matrix.
+*/
+static matrix* copyMatrix(matrix* m){
+    matrix* copy = matrixCreateWith(m->rows, m->cols, MATRIX_CREATE_ALIGNED | MATRIX_CREATE_UNINITIALIZED);
+    for(int i = 0; i < m->rows; i++){
+        memcpy(copy->data + MATRIX_ADDR(copy, i, 0), m->data + MATRIX_ADDR(m, i, 0), sizeof(double) * m->cols);
+    }
+    return copy;
+}
+
+/*
+    Create an n x n identity matrix.
+*/
+static matrix* identity(int n){
+    matrix* m = matrixCreate(n, n);
+    for(int i = 0; i < n; i++){
+        m->data[MATRIX_ADDR(m, i, i)] = 1.0;
+    }
+    return m;
+}
+
+/*
+    Solve L * X = B in place for the lower triangle of the n x n array a,
+    with a unit diagonal when `unit` is set. B has k columns.
+    Rows inside a diagonal block are eliminated one by one, then the rows
+    below the block are updated by a single GEMM.
+*/
+static void solveLower(int n, const double* a, int lda, int unit, double* b, int ldb, int k){
+    const elementwiseKernels* kernels = matrixElementwiseKernels();
+    for(int j = 0; j < n; j += MATRIX_SOLVE_BLOCK){
+        int nb = n - j < MATRIX_SOLVE_BLOCK ? n - j : MATRIX_SOLVE_BLOCK;
+        for(int r = j; r < j + nb; r++){
+            const double* rowA = a + (size_t)r * lda;
+            double* rowB = b + (size_t)r * ldb;
+            for(int q = j; q < r; q++){
+                kernels->axpy(k, b + (size_t)q * ldb, -rowA[q], rowB, rowB);
+            }
+            if(!unit){
+                kernels->mulScalar(k, rowB, 1.0 / rowA[r], rowB);
+            }
+        }
+        // B2 = B2 - L21 * X1
+        int rest = n - j - nb;
+        if(rest > 0){
+            matrixGemm(rest, k, nb, -1.0, a + (size_t)(j + nb) * lda + j, lda, b + (size_t)j * ldb, ldb,
+                       1.0, b + (size_t)(j + nb) * ldb, ldb);
+        }
+    }
+}
+
+/*
+    Solve U * X = B in place for the upper triangle (non-unit diagonal) of
+    the n x n array a. Blocks are processed from the bottom up, and the rows
+    above each block are updated by a single GEMM.
+*/
+static void solveUpper(int n, const double* a, int lda, double* b, int ldb, int k){
+    const elementwiseKernels* kernels = matrixElementwiseKernels();
+    for(int end = n; end > 0; end -= MATRIX_SOLVE_BLOCK){
+        int j = end > MATRIX_SOLVE_BLOCK ? end - MATRIX_SOLVE_BLOCK : 0;
+        for(int r = end - 1; r >= j; r--){
+            const double* rowA = a + (size_t)r * lda;
+            double* rowB = b + (size_t)r * ldb;
+            for(int q = r + 1; q < end; q++){
+                kernels->axpy(k, b + (size_t)q * ldb, -rowA[q], rowB, rowB);
+            }
+            kernels->mulScalar(k, rowB, 1.0 / rowA[r], rowB);
+        }
+        // B0 = B0 - U01 * X1
+        if(j > 0){
+            matrixGemm(j, k, end - j, -1.0, a + j, lda, b + (size_t)j * ldb, ldb, 1.0, b, ldb);
+        }
+    }
+}
+
+/*
+    Static helper checking that a factorization and right-hand sides fit together.
+    Prints an error message and returns 0 if they do not.
+*/
+static int checkRightHandSides(const void* f, int n, matrix* b){
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return 0;
+    }
+    if(b == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return 0;
+    }
+    if(b->rows != n){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    View a vector as a single-column matrix sharing its data.
+*/
+static matrix vectorAsColumn(vector* v){
+    matrix column = {v->size, 1, v->data, 1, 0};
+    return column;
+}
+
+luFactor* luFactorCreate(matrix* a){
+    // Check if matrix exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check if matrix is square
+    if(a->rows != a->cols){
+        fprintf(stderr, "Cannot factorize a non-square matrix.\n");
+        return NULL;
+    }
+    luFactor* f = malloc(sizeof(luFactor));
+    if(f == NULL){
+        allocationFailure();
+    }
+    f->n = a->rows;
+    f->lu = copyMatrix(a);
+    f->pivots = malloc(sizeof(int) * (f->n > 0 ? f->n : 1));
+    if(f->pivots == NULL){
+        allocationFailure();
+    }
+    // A zero pivot makes every solve divide by zero, so singular matrices are rejected
+    if(matrixLU(f->lu, f->pivots) != 0){
+        fprintf(stderr, "Matrix is singular.\n");
+        luFactorDelete(f);
+        return NULL;
+    }
+    return f;
+}
+
+void luFactorDelete(luFactor* f){
+    // Free the factorization if it exists (non-null pointer).
+    if(f != NULL){
+        matrixDelete(f->lu);
+        free(f->pivots);
+        free(f);
+    }
+    return;
+}
+
+matrix* luFactorSolveInPlace(luFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->n, b)){
+        return NULL;
+    }
+    // B = P * B, applying the interchanges in the order of the factorization
+    for(int i = 0; i < f->n; i++){
+        int p = f->pivots[i];
+        if(p != i){
+            double* rowI = b->data + MATRIX_ADDR(b, i, 0);
+            double* rowP = b->data + MATRIX_ADDR(b, p, 0);
+            for(int c = 0; c < b->cols; c++){
+                double tmp = rowI[c];
+                rowI[c] = rowP[c];
+                rowP[c] = tmp;
+            }
+        }
+    }
+    // L * Y = P * B, then U * X = Y
+    solveLower(f->n, f->lu->data, f->lu->stride, 1, b->data, b->stride, b->cols);
+    solveUpper(f->n, f->lu->data, f->lu->stride, b->data, b->stride, b->cols);
+    return b;
+}
+
+matrix* luFactorSolve(luFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->n, b)){
+        return NULL;
+    }
+    return luFactorSolveInPlace(f, copyMatrix(b));
+}
+
+vector* luFactorSolveVector(luFactor* f, vector* b){
+    // Check if vector exists (is not null)
+    if(b == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return NULL;
+    }
+    matrix column = vectorAsColumn(b);
+    return luFactorSolveInPlace(f, &column) == NULL ? NULL : b;
+}
+
+matrix* luFactorInverse(luFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NULL;
+    }
+    return luFactorSolveInPlace(f, identity(f->n));
+}
+
+double luFactorDet(luFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NAN;
+    }
+    // det(A) is the product of the diagonal of U, negated for every row swap
+    double det = 1.0;
+    for(int i = 0; i < f->n; i++){
+        det *= f->lu->data[MATRIX_ADDR(f->lu, i, i)];
+        if(f->pivots[i] != i){
+            det = -det;
+        }
+    }
+    return det;
+}
+
+/*
+    Blocked right-looking Cholesky factorization of the lower triangle of an
+    n x n array. Each panel of columns is factorized with dot products along
+    the rows, and the trailing lower triangle is updated block row by block
+    row with GEMMs against a transposed copy of the panel.
+    Returns 0, or index + 1 of the first non-positive pivot.
+*/
+static int choleskyFactorize(int n, double* a, int lda){
+    double* panelT = malloc(sizeof(double) * MATRIX_SOLVE_BLOCK * (n > 0 ? n : 1));
+    if(panelT == NULL){
+        allocationFailure();
+    }
+    int info = 0;
+    for(int j = 0; j < n && info == 0; j += MATRIX_SOLVE_BLOCK){
+        int nb = n - j < MATRIX_SOLVE_BLOCK ? n - j : MATRIX_SOLVE_BLOCK;
+        for(int kk = j; kk < j + nb; kk++){
+            double* rowK = a + (size_t)kk * lda;
+            double d = rowK[kk];
+            for(int c = j; c < kk; c++){
+                d -= rowK[c] * rowK[c];
+            }
+            // Also catches NaN
+            if(!(d > 0)){
+                info = kk + 1;
+                break;
+            }
+            rowK[kk] = sqrt(d);
+            for(int i = kk + 1; i < n; i++){
+                double* rowI = a + (size_t)i * lda;
+                double s = rowI[kk];
+                for(int c = j; c < kk; c++){
+                    s -= rowI[c] * rowK[c];
+                }
+                rowI[kk] = s / rowK[kk];
+            }
+        }
+        int rest = n - j - nb;
+        if(info != 0 || rest == 0){
+            continue;
+        }
+        // panelT = L21ᵀ (nb x rest)
+        for(int i = 0; i < rest; i++){
+            const double* rowI = a + (size_t)(j + nb + i) * lda + j;
+            for(int c = 0; c < nb; c++){
+                panelT[(size_t)c * rest + i] = rowI[c];
+            }
+        }
+        // A22 = A22 - L21 * L21ᵀ, only up to the diagonal of every block row
+        for(int i0 = 0; i0 < rest; i0 += MATRIX_SOLVE_BLOCK){
+            int ib = rest - i0 < MATRIX_SOLVE_BLOCK ? rest - i0 : MATRIX_SOLVE_BLOCK;
+            matrixGemm(ib, i0 + ib, nb, -1.0, a + (size_t)(j + nb + i0) * lda + j, lda, panelT, rest,
+                       1.0, a + (size_t)(j + nb + i0) * lda + j + nb, lda);
+        }
+    }
+    free(panelT);
+    return info;
+}
+
+choleskyFactor* choleskyFactorCreate(matrix* a){
+    // Check if matrix exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // Check if matrix is square
+    if(a->rows != a->cols){
+        fprintf(stderr, "Cannot factorize a non-square matrix.\n");
+        return NULL;
+    }
+    choleskyFactor* f = malloc(sizeof(choleskyFactor));
+    if(f == NULL){
+        allocationFailure();
+    }
+    f->n = a->rows;
+    f->l = copyMatrix(a);
+    if(choleskyFactorize(f->n, f->l->data, f->l->stride) != 0){
+        fprintf(stderr, "Matrix is not positive definite.\n");
+        choleskyFactorDelete(f);
+        return NULL;
+    }
+    // Mirror L into the upper triangle, so the solve with Lᵀ reads rows as well
+    for(int i = 0; i < f->n; i++){
+        for(int j = i + 1; j < f->n; j++){
+            f->l->data[MATRIX_ADDR(f->l, i, j)] = f->l->data[MATRIX_ADDR(f->l, j, i)];
+        }
+    }
+    return f;
+}
+
+void choleskyFactorDelete(choleskyFactor* f){
+    // Free the factorization if it exists (non-null pointer).
+    if(f != NULL){
+        matrixDelete(f->l);
+        free(f);
+    }
+    return;
+}
+
+matrix* choleskyFactorSolveInPlace(choleskyFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->n, b)){
+        return NULL;
+    }
+    // L * Y = B, then Lᵀ * X = Y
+    solveLower(f->n, f->l->data, f->l->stride, 0, b->data, b->stride, b->cols);
+    solveUpper(f->n, f->l->data, f->l->stride, b->data, b->stride, b->cols);
+    return b;
+}
+
+matrix* choleskyFactorSolve(choleskyFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->n, b)){
+        return NULL;
+    }
+    return choleskyFactorSolveInPlace(f, copyMatrix(b));
+}
+
+vector* choleskyFactorSolveVector(choleskyFactor* f, vector* b){
+    // Check if vector exists (is not null)
+    if(b == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return NULL;
+    }
+    matrix column = vectorAsColumn(b);
+    return choleskyFactorSolveInPlace(f, &column) == NULL ? NULL : b;
+}
+
+matrix* choleskyFactorInverse(choleskyFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NULL;
+    }
+    return choleskyFactorSolveInPlace(f, identity(f->n));
+}
+
+double choleskyFactorDet(choleskyFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NAN;
+    }
+    // det(A) = det(L)², the squared product of the diagonal of L
+    double det = 1.0;
+    for(int i = 0; i < f->n; i++){
+        det *= f->l->data[MATRIX_ADDR(f->l, i, i)];
+    }
+    return det * det;
+}
+
+matrix* matrixSolve(matrix* a, matrix* b){
+    // Check if matrices exist (are not null)
+    if(a == NULL || b == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify the dimensions before paying for the factorization
+    if(b->rows != a->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    luFactor* f = luFactorCreate(a);
+    if(f == NULL){
+        return NULL;
+    }
+    matrix* x = luFactorSolve(f, b);
+    luFactorDelete(f);
+    return x;
+}
+
+matrix* matrixInverse(matrix* a){
+    luFactor* f = luFactorCreate(a);
+    if(f == NULL){
+        return NULL;
+    }
+    matrix* inverse = luFactorInverse(f);
+    luFactorDelete(f);
+    return inverse;
+}
+
+/*
+    y = y + s * x for the short rows of narrow blocks. The arrays never
+    overlap, which lets the loop be vectorized without runtime checks.
+*/
+static inline void qrAxpy(int n, double s, const double* restrict x, double* restrict y){
+    for(int j = 0; j < n; j++){
+        y[j] += s * x[j];
+    }
+}
+
+/*
+    Copy rows [i0, i0 + rows) of a block of k Householder vectors into a
+    k x rows transposed buffer. The first `unit` rows of the block hold a unit
+    lower triangle: the ones on its diagonal and the zeros above it are implied.
+*/
+static void qrTransposeVectors(int i0, int rows, int k, const double* v, int ldv, int unit, double* buffer){
+    for(int r = 0; r < rows; r++){
+        int i = i0 + r;
+        const double* row = v + (size_t)i * ldv;
+        for(int c = 0; c < k; c++){
+            buffer[(size_t)c * rows + r] = i >= unit || c < i ? row[c] : c == i ? 1.0 : 0.0;
+        }
+    }
+}
+
+/*
+    Arguments of out = Vᵀ * C for an m x k block of Householder vectors v
+    and an m x w array c. With `parts` > 0 the rows are split into that many
+    partitions, each producing a partial k x w result in out.
+*/
+typedef struct {
+    int m;
+    int k;
+    int w;
+    const double* v;
+    int ldv;
+    int unit;
+    const double* c;
+    int ldc;
+    double* out;
+    int ldo;
+    int parts;
+} qrProductStep;
+
+/*
+    Compute the columns [j0, j1) of the product over the rows [i0, i1) for a
+    narrow block of vectors, adding every row of C to the results in one pass.
+*/
+static void qrProductNarrow(qrProductStep* step, int i0, int i1, int j0, int j1, double* out, int ldo){
+    int w = j1 - j0;
+    for(int r = 0; r < step->k; r++){
+        memset(out + (size_t)r * ldo, 0, sizeof(double) * w);
+    }
+    for(int i = i0; i < i1; i++){
+        const double* rowV = step->v + (size_t)i * step->ldv;
+        const double* rowC = step->c + (size_t)i * step->ldc + j0;
+        // Row i of the unit triangle has its stored elements left of the diagonal and a one on it
+        int stored = i < step->unit && i < step->k ? i : step->k;
+        for(int r = 0; r < stored; r++){
+            qrAxpy(w, rowV[r], rowC, out + (size_t)r * ldo);
+        }
+        if(stored < step->k && i < step->unit){
+            qrAxpy(w, 1.0, rowC, out + (size_t)i * ldo);
+        }
+    }
+}
+
+/*
+    Compute the columns [j0, j1) of the product over the rows [i0, i1), one
+    transposed chunk of vectors and one GEMM at a time.
+*/
+static void qrProductRows(qrProductStep* step, int i0, int i1, int j0, int j1, double* out, int ldo){
+    if(i0 >= i1){
+        for(int r = 0; r < step->k; r++){
+            memset(out + (size_t)r * ldo, 0, sizeof(double) * (j1 - j0));
+        }
+        return;
+    }
+    if(step->k <= MATRIX_QR_NARROW){
+        qrProductNarrow(step, i0, i1, j0, j1, out, ldo);
+        return;
+    }
+    int chunk = MATRIX_QR_CHUNK / step->k > 0 ? MATRIX_QR_CHUNK / step->k : 1;
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    double* buffer = matrixArenaAlloc(arena, sizeof(double) * step->k * chunk);
+    for(int i = i0; i < i1; i += chunk){
+        int rows = i1 - i < chunk ? i1 - i : chunk;
+        qrTransposeVectors(i, rows, step->k, step->v, step->ldv, step->unit, buffer);
+        matrixGemm(step->k, j1 - j0, rows, 1.0, buffer, rows, step->c + (size_t)i * step->ldc + j0, step->ldc,
+                   i == i0 ? 0.0 : 1.0, out, ldo);
+    }
+    matrixArenaRelease(arena, mark);
+}
+
+static void qrProductColumnsTask(void* arg, int begin, int end){
+    qrProductStep* step = arg;
+    for(int b = begin; b < end; b++){
+        int j0 = b * QR_COLUMN_BLOCK;
+        int j1 = step->w - j0 < QR_COLUMN_BLOCK ? step->w : j0 + QR_COLUMN_BLOCK;
+        qrProductRows(step, 0, step->m, j0, j1, step->out + j0, step->ldo);
+    }
+}
+
+static void qrProductPartsTask(void* arg, int begin, int end){
+    qrProductStep* step = arg;
+    for(int p = begin; p < end; p++){
+        int i0 = (int)((long long)step->m * p / step->parts);
+        int i1 = (int)((long long)step->m * (p + 1) / step->parts);
+        qrProductRows(step, i0, i1, 0, step->w, step->out + (size_t)p * step->k * step->w, step->w);
+    }
+}
+
+/*
+    Compute out = Vᵀ * C (k x w) for an m x k block of Householder vectors
+    whose first `unit` rows hold a unit lower triangle. Wide products are
+    split by columns across the threads, tall ones by rows into partial
+    results that are added up at the end.
+*/
+static void qrProduct(int m, int k, const double* v, int ldv, int unit, int w, const double* c, int ldc, double* out, int ldo){
+    qrProductStep step = {m, k, w, v, ldv, unit, c, ldc, out, ldo, 0};
+    int threads = matrixGetNumThreads();
+    if(threads == 1 || (long long)m * k * w < MATRIX_QR_PARALLEL_THRESHOLD){
+        qrProductRows(&step, 0, m, 0, w, out, ldo);
+        return;
+    }
+    int blocks = (w + QR_COLUMN_BLOCK - 1) / QR_COLUMN_BLOCK;
+    if(blocks >= threads){
+        matrixParallelFor(blocks, 1, qrProductColumnsTask, &step);
+        return;
+    }
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    step.parts = threads;
+    step.out = matrixArenaAlloc(arena, sizeof(double) * threads * k * w);
+    matrixParallelFor(step.parts, 1, qrProductPartsTask, &step);
+    for(int r = 0; r < k; r++){
+        double* rowOut = out + (size_t)r * ldo;
+        memcpy(rowOut, step.out + (size_t)r * w, sizeof(double) * w);
+        for(int p = 1; p < step.parts; p++){
+            const double* partial = step.out + ((size_t)p * k + r) * w;
+            for(int j = 0; j < w; j++){
+                rowOut[j] += partial[j];
+            }
+        }
+    }
+    matrixArenaRelease(arena, mark);
+}
+
+/*
+    Arguments of C = C - V * W for a narrow block of k vectors, whose first k
+    rows hold the unit triangle.
+*/
+typedef struct {
+    int k;
+    const double* v;
+    int ldv;
+    double* c;
+    int ldc;
+    int w;
+    const double* work;
+} qrUpdateStep;
+
+static void qrUpdateNarrowTask(void* arg, int begin, int end){
+    qrUpdateStep* step = arg;
+    for(int i = begin; i < end; i++){
+        const double* rowV = step->v + (size_t)i * step->ldv;
+        double* rowC = step->c + (size_t)i * step->ldc;
+        int stored = i < step->k ? i : step->k;
+        for(int r = 0; r < stored; r++){
+            qrAxpy(step->w, -rowV[r], step->work + (size_t)r * step->w, rowC);
+        }
+        if(i < step->k){
+            qrAxpy(step->w, -1.0, step->work + (size_t)i * step->w, rowC);
+        }
+    }
+}
+
+/*
+    Apply the block reflector H = I - V * T * Vᵀ of k Householder vectors
+    (m x k, unit lower trapezoidal) to the m x w array c from the left:
+    c = Hᵀ * c when `transpose` is set, c = H * c otherwise.
+    Both products with V are GEMMs, so this is where the factorization spends its time.
+*/
+static void qrApplyBlock(int transpose, int m, int k, const double* v, int ldv, const double* t, int ldt, double* c, int ldc, int w){
+    if(w == 0 || k == 0){
+        return;
+    }
+    const elementwiseKernels* kernels = matrixElementwiseKernels();
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    // W = Vᵀ * C
+    double* work = matrixArenaAlloc(arena, sizeof(double) * k * w);
+    qrProduct(m, k, v, ldv, k, w, c, ldc, work, w);
+    // W = Tᵀ * W or T * W in place, ordered so every row only reads rows not yet overwritten
+    if(transpose){
+        for(int r = k - 1; r >= 0; r--){
+            double* rowW = work + (size_t)r * w;
+            kernels->mulScalar(w, rowW, t[(size_t)r * ldt + r], rowW);
+            for(int q = 0; q < r; q++){
+                kernels->axpy(w, work + (size_t)q * w, t[(size_t)q * ldt + r], rowW, rowW);
+            }
+        }
+    }
+    else{
+        for(int r = 0; r < k; r++){
+            double* rowW = work + (size_t)r * w;
+            kernels->mulScalar(w, rowW, t[(size_t)r * ldt + r], rowW);
+            for(int q = r + 1; q < k; q++){
+                kernels->axpy(w, work + (size_t)q * w, t[(size_t)r * ldt + q], rowW, rowW);
+            }
+        }
+    }
+    if(k <= MATRIX_QR_NARROW){
+        qrUpdateStep update = {k, v, ldv, c, ldc, w, work};
+        matrixParallelFor(m, MATRIX_QR_ROWS, qrUpdateNarrowTask, &update);
+        matrixArenaRelease(arena, mark);
+        return;
+    }
+    // C = C - V * W, with the unit triangle of V made explicit in a small copy
+    double* v1 = matrixArenaAlloc(arena, sizeof(double) * k * k);
+    for(int i = 0; i < k; i++){
+        for(int q = 0; q < k; q++){
+            v1[(size_t)i * k + q] = q < i ? v[(size_t)i * ldv + q] : q == i ? 1.0 : 0.0;
+        }
+    }
+    matrixGemm(k, w, k, -1.0, v1, k, work, w, 1.0, c, ldc);
+    if(m > k){
+        matrixGemm(m - k, w, k, -1.0, v + (size_t)k * ldv, ldv, work, w, 1.0, c + (size_t)k * ldc, ldc);
+    }
+    matrixArenaRelease(arena, mark);
+}
+
+/*
+    Arguments of the passes over the rows of an unblocked panel factorization
+    reducing column c. Every block of MATRIX_QR_ROWS rows writes its partial
+    sums to its own n elements of `sums`, which are added up in order, so the
+    result does not depend on the number of threads.
+*/
+typedef struct {
+    int m;
+    int n;
+    double* a;
+    int lda;
+    int c;
+    double scale;
+    double tau;
+    const double* w;
+    double* sums;
+} qrPanelStep;
+
+/*
+    Scale the elements of column c below the diagonal into the Householder
+    vector v, and sum v * (every other element of the row): the columns on the
+    right give w = vᵀ * A, the ones on the left Vᵀ * v for the T factor.
+*/
+static void qrPanelReflectTask(void* arg, int begin, int end){
+    qrPanelStep* step = arg;
+    for(int b = begin; b < end; b++){
+        int i0 = b * MATRIX_QR_ROWS > step->c + 1 ? b * MATRIX_QR_ROWS : step->c + 1;
+        int i1 = step->m - b * MATRIX_QR_ROWS < MATRIX_QR_ROWS ? step->m : (b + 1) * MATRIX_QR_ROWS;
+        double partial[MATRIX_QR_NARROW] = {0.0};
+        for(int i = i0; i < i1; i++){
+            double* row = step->a + (size_t)i * step->lda;
+            double v = row[step->c] *= step->scale;
+            qrAxpy(step->n, v, row, partial);
+        }
+        memcpy(step->sums + (size_t)b * step->n, partial, sizeof(double) * step->n);
+    }
+}
+
+/*
+    Apply the reflector of column c to the rows below the diagonal
+    (row -= tau * v * w) and sum the squares of column c + 1 below its
+    diagonal, which are needed by the next reflector.
+*/
+static void qrPanelUpdateTask(void* arg, int begin, int end){
+    qrPanelStep* step = arg;
+    int next = step->c + 1;
+    for(int b = begin; b < end; b++){
+        int i0 = b * MATRIX_QR_ROWS > next ? b * MATRIX_QR_ROWS : next;
+        int i1 = step->m - b * MATRIX_QR_ROWS < MATRIX_QR_ROWS ? step->m : (b + 1) * MATRIX_QR_ROWS;
+        double squares = 0.0;
+        for(int i = i0; i < i1; i++){
+            double* row = step->a + (size_t)i * step->lda;
+            if(step->tau != 0){
+                qrAxpy(step->n - next, -step->tau * row[step->c], step->w + next, row + next);
+            }
+            if(next < step->n && i > next){
+                squares += row[next] * row[next];
+            }
+        }
+        step->sums[(size_t)b * step->n] = squares;
+    }
+}
+
+/*
+    Norm of the column x[i * ld], i < n, scaled by its largest element,
+    for sums of squares that overflowed or lost precision to underflow.
+*/
+static double qrScaledNorm(int n, const double* x, int ld){
+    double scale = 0.0;
+    for(int i = 0; i < n; i++){
+        scale = fmax(scale, fabs(x[(size_t)i * ld]));
+    }
+    if(scale == 0 || isinf(scale)){
+        return scale;
+    }
+    double sum = 0.0;
+    for(int i = 0; i < n; i++){
+        double t = x[(size_t)i * ld] / scale;
+        sum += t * t;
+    }
+    return scale * sqrt(sum);
+}
+
+/*
+    Unblocked Householder QR factorization of a narrow m x n panel (m >= n),
+    with the triangular factor T built column by column. Every column costs
+    two passes over the rows, split into blocks across the threads: one
+    forms the reflector and the sums it needs, the other applies it.
+*/
+static void qrFactorPanelUnblocked(int m, int n, double* a, int lda, double* tau, double* t, int ldt){
+    int blocks = (m + MATRIX_QR_ROWS - 1) / MATRIX_QR_ROWS;
+    matrixArena* arena = matrixArenaScratch();
+    matrixArenaMark mark = matrixArenaGetMark(arena);
+    double* w = matrixArenaAlloc(arena, sizeof(double) * n);
+    qrPanelStep step = {m, n, a, lda, -1, 1.0, 0.0, w, matrixArenaAlloc(arena, sizeof(double) * blocks * n)};
+    // An update pass of column -1 only sums the squares of column 0
+    matrixParallelFor(blocks, 1, qrPanelUpdateTask, &step);
+    for(int c = 0; c < n; c++){
+        double* rowC = a + (size_t)c * lda;
+        double sum = 0.0;
+        for(int b = 0; b < blocks; b++){
+            sum += step.sums[(size_t)b * n];
+        }
+        double norm = sqrt(sum);
+        if(!isnan(sum) && !(isfinite(sum) && sum >= DBL_MIN)){
+            norm = qrScaledNorm(m - c - 1, rowC + lda + c, lda);
+        }
+        // H = I - tau * v * vᵀ maps the column to beta * e1; nothing to zero means H = I
+        step.c = c;
+        step.tau = 0.0;
+        step.scale = 1.0;
+        if(norm != 0){
+            double alpha = rowC[c];
+            double beta = -copysign(hypot(alpha, norm), alpha);
+            step.tau = (beta - alpha) / beta;
+            step.scale = 1.0 / (alpha - beta);
+            rowC[c] = beta;
+        }
+        tau[c] = step.tau;
+        matrixParallelFor(blocks, 1, qrPanelReflectTask, &step);
+        // Row c holds the implied first element of v, a one
+        for(int j = 0; j < n; j++){
+            w[j] = j == c ? 0.0 : rowC[j];
+            for(int b = 0; b < blocks; b++){
+                w[j] += step.sums[(size_t)b * n + j];
+            }
+        }
+        // T[0:c, c] = -tau * T[0:c, 0:c] * (Vᵀ * v)[0:c]
+        for(int q = 0; q < c; q++){
+            double s = 0.0;
+            for(int p = q; p < c; p++){
+                s += t[(size_t)q * ldt + p] * w[p];
+            }
+            t[(size_t)q * ldt + c] = -step.tau * s;
+        }
+        t[(size_t)c * ldt + c] = step.tau;
+        for(int j = c + 1; j < n; j++){
+            rowC[j] -= step.tau * w[j];
+        }
+        matrixParallelFor(blocks, 1, qrPanelUpdateTask, &step);
+    }
+    matrixArenaRelease(arena, mark);
+}
+
+/*
+    Recursive QR factorization of an m x n panel (m >= n): the left half is
+    factorized and applied to the right half, which is then factorized below
+    it. The upper triangular n x n factor T of the block reflector
+    Q = H1 * ... * Hn = I - V * T * Vᵀ is assembled on the way back, so
+    almost all of the work is GEMMs even inside the panel.
+*/
+static void qrFactorPanel(int m, int n, double* a, int lda, double* tau, double* t, int ldt){
+    if(n <= MATRIX_QR_NARROW){
+        qrFactorPanelUnblocked(m, n, a, lda, tau, t, ldt);
+        return;
+    }
+    int n1 = n / 2;
+    int n2 = n - n1;
+    qrFactorPanel(m, n1, a, lda, tau, t, ldt);
+    qrApplyBlock(1, m, n1, a, lda, t, ldt, a + n1, lda, n2);
+    double* a22 = a + (size_t)n1 * lda + n1;
+    double* t12 = t + n1;
+    double* t22 = t + (size_t)n1 * ldt + n1;
+    qrFactorPanel(m - n1, n2, a22, lda, tau + n1, t22, ldt);
+
+    // T12 = -T11 * (V1ᵀ * V2) * T22, where V2 starts n1 rows below V1.
+    // Below row n both vectors are plain and their product is a GEMM.
+    qrProduct(m - n, n1, a + (size_t)n * lda, lda, 0, n2, a22 + (size_t)n2 * lda, lda, t12, ldt);
+    // Rows n1 to n meet the unit triangle of V2
+    for(int r = 0; r < n2; r++){
+        const double* rowV1 = a + (size_t)(n1 + r) * lda;
+        const double* rowV2 = a22 + (size_t)r * lda;
+        for(int q = 0; q < n1; q++){
+            double* rowT = t12 + (size_t)q * ldt;
+            for(int c = 0; c < r; c++){
+                rowT[c] += rowV1[q] * rowV2[c];
+            }
+            rowT[r] += rowV1[q];
+        }
+    }
+    // T12 = T12 * T22, right to left within every row
+    for(int q = 0; q < n1; q++){
+        double* rowT = t12 + (size_t)q * ldt;
+        for(int c = n2 - 1; c >= 0; c--){
+            double s = 0.0;
+            for(int p = 0; p <= c; p++){
+                s += rowT[p] * t22[(size_t)p * ldt + c];
+            }
+            rowT[c] = s;
+        }
+    }
+    // T12 = -T11 * T12, top to bottom
+    for(int q = 0; q < n1; q++){
+        double* rowT = t12 + (size_t)q * ldt;
+        for(int c = 0; c < n2; c++){
+            double s = 0.0;
+            for(int p = q; p < n1; p++){
+                s += t[(size_t)q * ldt + p] * t12[(size_t)p * ldt + c];
+            }
+            rowT[c] = -s;
+        }
+    }
+}
+
+/*
+    Blocked Householder QR factorization of an m x n array in place.
+    Every block of MATRIX_SOLVE_BLOCK columns is factorized recursively, and
+    its block reflector is applied to the columns on its right with GEMMs.
+    The triangular factor of block j is stored at columns j.. of t.
+*/
+static void qrFactorize(int m, int n, double* a, int lda, double* tau, double* t, int ldt){
+    int k = m < n ? m : n;
+    for(int j = 0; j < k; j += MATRIX_SOLVE_BLOCK){
+        int nb = k - j < MATRIX_SOLVE_BLOCK ? k - j : MATRIX_SOLVE_BLOCK;
+        double* panel = a + (size_t)j * lda + j;
+        qrFactorPanel(m - j, nb, panel, lda, tau + j, t + j, ldt);
+        if(j + nb < n){
+            qrApplyBlock(1, m - j, nb, panel, lda, t + j, ldt, panel + nb, lda, n - j - nb);
+        }
+    }
+}
+
+/*
+    Multiply b in place by Qᵀ when `transpose` is set, by Q otherwise.
+*/
+static void qrApplyQ(qrFactor* f, int transpose, matrix* b){
+    int k = f->rows < f->cols ? f->rows : f->cols;
+    int blocks = (k + MATRIX_SOLVE_BLOCK - 1) / MATRIX_SOLVE_BLOCK;
+    for(int step = 0; step < blocks; step++){
+        // Qᵀ applies the blocks first to last, Q last to first
+        int j = (transpose ? step : blocks - 1 - step) * MATRIX_SOLVE_BLOCK;
+        int nb = k - j < MATRIX_SOLVE_BLOCK ? k - j : MATRIX_SOLVE_BLOCK;
+        qrApplyBlock(transpose, f->rows - j, nb, f->qr->data + MATRIX_ADDR(f->qr, j, j), f->qr->stride,
+                     f->t->data + j, f->t->stride, b->data + MATRIX_ADDR(b, j, 0), b->stride, b->cols);
+    }
+}
+
+qrFactor* qrFactorCreate(matrix* a){
+    // Check if matrix exists (is not null)
+    if(a == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    int k = a->rows < a->cols ? a->rows : a->cols;
+    qrFactor* f = malloc(sizeof(qrFactor));
+    double* tau = malloc(sizeof(double) * (k > 0 ? k : 1));
+    if(f == NULL || tau == NULL){
+        allocationFailure();
+    }
+    f->rows = a->rows;
+    f->cols = a->cols;
+    f->qr = copyMatrix(a);
+    f->tau = tau;
+    f->t = matrixCreate(MATRIX_SOLVE_BLOCK, k);
+    qrFactorize(f->rows, f->cols, f->qr->data, f->qr->stride, f->tau, f->t->data, f->t->stride);
+    return f;
+}
+
+void qrFactorDelete(qrFactor* f){
+    // Free the factorization if it exists (non-null pointer).
+    if(f != NULL){
+        matrixDelete(f->qr);
+        matrixDelete(f->t);
+        free(f->tau);
+        free(f);
+    }
+    return;
+}
+
+matrix* qrFactorQ(qrFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NULL;
+    }
+    // Q is Q times the first k columns of the identity
+    int k = f->rows < f->cols ? f->rows : f->cols;
+    matrix* q = matrixCreate(f->rows, k);
+    for(int i = 0; i < k; i++){
+        q->data[MATRIX_ADDR(q, i, i)] = 1.0;
+    }
+    qrApplyQ(f, 0, q);
+    return q;
+}
+
+matrix* qrFactorR(qrFactor* f){
+    // Check if factorization exists (is not null)
+    if(f == NULL){
+        fprintf(stderr, "Factorization does not exist.\n");
+        return NULL;
+    }
+    int k = f->rows < f->cols ? f->rows : f->cols;
+    matrix* r = matrixCreate(k, f->cols);
+    for(int i = 0; i < k; i++){
+        memcpy(r->data + MATRIX_ADDR(r, i, i), f->qr->data + MATRIX_ADDR(f->qr, i, i), sizeof(double) * (f->cols - i));
+    }
+    return r;
+}
+
+matrix* qrFactorMulQtInPlace(qrFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->rows, b)){
+        return NULL;
+    }
+    qrApplyQ(f, 1, b);
+    return b;
+}
+
+matrix* qrFactorLeastSquares(qrFactor* f, matrix* b){
+    if(!checkRightHandSides(f, f == NULL ? 0 : f->rows, b)){
+        return NULL;
+    }
+    if(f->rows < f->cols){
+        fprintf(stderr, "Least squares needs at least as many rows as columns.\n");
+        return NULL;
+    }
+    // Rounding leaves tiny rather than zero diagonal elements in R for dependent columns
+    double largest = 0.0;
+    for(int i = 0; i < f->cols; i++){
+        largest = fmax(largest, fabs(f->qr->data[MATRIX_ADDR(f->qr, i, i)]));
+    }
+    for(int i = 0; i < f->cols; i++){
+        if(!(fabs(f->qr->data[MATRIX_ADDR(f->qr, i, i)]) > DBL_EPSILON * f->rows * largest)){
+            fprintf(stderr, "Matrix is rank deficient.\n");
+            return NULL;
+        }
+    }
+    // R * X = (Qᵀ * B)[0:n]; the remaining rows of Qᵀ * B are the residual
+    matrix* y = copyMatrix(b);
+    qrApplyQ(f, 1, y);
+    solveUpper(f->cols, f->qr->data, f->qr->stride, y->data, y->stride, y->cols);
+    matrix* x = matrixCreateWith(f->cols, b->cols, MATRIX_CREATE_UNINITIALIZED);
+    for(int i = 0; i < x->rows; i++){
+        memcpy(x->data + MATRIX_ADDR(x, i, 0), y->data + MATRIX_ADDR(y, i, 0), sizeof(double) * x->cols);
+    }
+    matrixDelete(y);
+    return x;
+}
+
+vector* qrFactorLeastSquaresVector(qrFactor* f, vector* b){
+    // Check if vector exists (is not null)
+    if(b == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return NULL;
+    }
+    matrix column = vectorAsColumn(b);
+    matrix* x = qrFactorLeastSquares(f, &column);
+    if(x == NULL){
+        return NULL;
+    }
+    vector* result = vectorCreate(x->rows);
+    for(int i = 0; i < x->rows; i++){
+        result->data[i] = x->data[MATRIX_ADDR(x, i, 0)];
+    }
+    matrixDelete(x);
+    return result;
+}
+
+matrix* matrixLeastSquares(matrix* a, matrix* b){
+    // Check if matrices exist (are not null)
+    if(a == NULL || b == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify the dimensions before paying for the factorization
+    if(b->rows != a->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(a->rows < a->cols){
+        fprintf(stderr, "Least squares needs at least as many rows as columns.\n");
+        return NULL;
+    }
+    qrFactor* f = qrFactorCreate(a);
+    matrix* x = qrFactorLeastSquares(f, b);
+    qrFactorDelete(f);
+    return x;
+}
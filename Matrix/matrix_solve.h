@@ -0,0 +1,239 @@
+#ifndef MATRIX_SOLVE_H
+#define MATRIX_SOLVE_H
+
+#include "matrix.h"
+#include "matrix_vector.h"
+
+/**
+ * LU factorization with partial pivoting (P * A = L * U) of a square matrix,
+ * computed once and reused by every solve.
+ */
+typedef struct {
+    int n;          /** Order of the factorized matrix */
+    matrix* lu;     /** L below the diagonal (unit diagonal not stored) and U on and above it */
+    int* pivots;    /** Row i was interchanged with row pivots[i] at step i */
+} luFactor;
+
+/**
+ * Cholesky factorization (A = L * Lᵀ) of a symmetric positive definite
+ * matrix, computed once and reused by every solve.
+ */
+typedef struct {
+    int n;          /** Order of the factorized matrix */
+    matrix* l;      /** L on and below the diagonal, Lᵀ above it */
+} choleskyFactor;
+
+/**
+ * Householder QR factorization (A = Q * R) of an m x n matrix, computed once
+ * and reused by every solve. Q is kept as its Householder reflectors in
+ * compact WY form (blocks of I - V * T * Vᵀ), so it is applied with GEMMs
+ * and never formed unless asked for.
+ */
+typedef struct {
+    int rows;       /** Number of rows of the factorized matrix */
+    int cols;       /** Number of columns of the factorized matrix */
+    matrix* qr;     /** R on and above the diagonal, Householder vectors below it (unit first element not stored) */
+    double* tau;    /** Scale of every Householder reflector (min(rows, cols)) */
+    matrix* t;      /** Triangular factor T of every block of reflectors, side by side */
+} qrFactor;
+
+/**
+ * Compute the LU factorization of a square matrix.
+ * The matrix is not modified. Function allocates memory for the factorization automatically.
+ * @param a Pointer to the square matrix
+ * @return Pointer to the factorization, or NULL if the matrix is not square or singular
+ */
+luFactor* luFactorCreate(matrix* a);
+
+/**
+ * Free the memory associated with the factorization.
+ * @param f Pointer to the factorization to delete
+ */
+void luFactorDelete(luFactor* f);
+
+/**
+ * Solve A * X = B in place for any number of right-hand sides (the columns of b).
+ * The triangular solves are blocked, so most of the work is matrix multiplication.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the right-hand sides (f->n × k), overwritten by X
+ * @return b, or NULL if dimensions mismatch
+ */
+matrix* luFactorSolveInPlace(luFactor* f, matrix* b);
+
+/**
+ * Solve A * X = B.
+ * Function allocates memory for the solution automatically.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the right-hand sides (f->n × k)
+ * @return Pointer to the solution X, or NULL if dimensions mismatch
+ */
+matrix* luFactorSolve(luFactor* f, matrix* b);
+
+/**
+ * Solve A * x = b in place for a single right-hand side.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the vector of f->n elements, overwritten by x
+ * @return b, or NULL if dimensions mismatch
+ */
+vector* luFactorSolveVector(luFactor* f, vector* b);
+
+/**
+ * Compute the inverse of the factorized matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param f Pointer to the factorization
+ * @return Pointer to the inverse, or NULL if f is NULL
+ */
+matrix* luFactorInverse(luFactor* f);
+
+/**
+ * Compute the determinant of the factorized matrix.
+ * @param f Pointer to the factorization
+ * @return Determinant, or NAN if f is NULL
+ */
+double luFactorDet(luFactor* f);
+
+/**
+ * Compute the Cholesky factorization of a symmetric positive definite matrix.
+ * Only the lower triangle of the matrix is read; the matrix is not modified.
+ * Function allocates memory for the factorization automatically.
+ * @param a Pointer to the square matrix
+ * @return Pointer to the factorization, or NULL if the matrix is not square or not positive definite
+ */
+choleskyFactor* choleskyFactorCreate(matrix* a);
+
+/**
+ * Free the memory associated with the factorization.
+ * @param f Pointer to the factorization to delete
+ */
+void choleskyFactorDelete(choleskyFactor* f);
+
+/**
+ * Solve A * X = B in place for any number of right-hand sides (the columns of b).
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the right-hand sides (f->n × k), overwritten by X
+ * @return b, or NULL if dimensions mismatch
+ */
+matrix* choleskyFactorSolveInPlace(choleskyFactor* f, matrix* b);
+
+/**
+ * Solve A * X = B.
+ * Function allocates memory for the solution automatically.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the right-hand sides (f->n × k)
+ * @return Pointer to the solution X, or NULL if dimensions mismatch
+ */
+matrix* choleskyFactorSolve(choleskyFactor* f, matrix* b);
+
+/**
+ * Solve A * x = b in place for a single right-hand side.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the vector of f->n elements, overwritten by x
+ * @return b, or NULL if dimensions mismatch
+ */
+vector* choleskyFactorSolveVector(choleskyFactor* f, vector* b);
+
+/**
+ * Compute the inverse of the factorized matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param f Pointer to the factorization
+ * @return Pointer to the inverse, or NULL if f is NULL
+ */
+matrix* choleskyFactorInverse(choleskyFactor* f);
+
+/**
+ * Compute the determinant of the factorized matrix.
+ * @param f Pointer to the factorization
+ * @return Determinant, or NAN if f is NULL
+ */
+double choleskyFactorDet(choleskyFactor* f);
+
+/**
+ * Compute the QR factorization of any matrix with blocked Householder
+ * reflections. Blocks of columns are factorized recursively and applied to
+ * the rest of the matrix with matrix multiplications; tall matrices (e.g.
+ * millions of rows) are processed by multiple threads.
+ * The matrix is not modified. Function allocates memory for the factorization automatically.
+ * @param a Pointer to the matrix
+ * @return Pointer to the factorization, or NULL if a is NULL
+ */
+qrFactor* qrFactorCreate(matrix* a);
+
+/**
+ * Free the memory associated with the factorization.
+ * @param f Pointer to the factorization to delete
+ */
+void qrFactorDelete(qrFactor* f);
+
+/**
+ * Form the thin orthogonal factor Q (rows × min(rows, cols)).
+ * Function allocates memory for the matrix automatically.
+ * @param f Pointer to the factorization
+ * @return Pointer to Q, or NULL if f is NULL
+ */
+matrix* qrFactorQ(qrFactor* f);
+
+/**
+ * Copy the upper triangular factor R (min(rows, cols) × cols).
+ * Function allocates memory for the matrix automatically.
+ * @param f Pointer to the factorization
+ * @return Pointer to R, or NULL if f is NULL
+ */
+matrix* qrFactorR(qrFactor* f);
+
+/**
+ * Compute Qᵀ * B in place, without forming Q.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the matrix (f->rows × k), overwritten by Qᵀ * B
+ * @return b, or NULL if dimensions mismatch
+ */
+matrix* qrFactorMulQtInPlace(qrFactor* f, matrix* b);
+
+/**
+ * Solve the least-squares problem min ||A * X - B|| for a matrix with at least
+ * as many rows as columns and full column rank, as R * X = (Qᵀ * B)[0:cols].
+ * Function allocates memory for the solution automatically.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the right-hand sides (f->rows × k)
+ * @return Pointer to the solution X (f->cols × k), or NULL if dimensions mismatch or A is rank deficient
+ */
+matrix* qrFactorLeastSquares(qrFactor* f, matrix* b);
+
+/**
+ * Solve the least-squares problem min ||A * x - b|| for a single right-hand side.
+ * Function allocates memory for the vector automatically.
+ * @param f Pointer to the factorization of A
+ * @param b Pointer to the vector of f->rows elements
+ * @return Pointer to the solution of f->cols elements, or NULL if dimensions mismatch or A is rank deficient
+ */
+vector* qrFactorLeastSquaresVector(qrFactor* f, vector* b);
+
+/**
+ * Solve A * X = B with a temporary LU factorization.
+ * Use luFactorCreate to solve repeatedly with the same A.
+ * Function allocates memory for the solution automatically.
+ * @param a Pointer to the square matrix A
+ * @param b Pointer to the right-hand sides (a->rows × k)
+ * @return Pointer to the solution X, or NULL if A is singular or dimensions mismatch
+ */
+matrix* matrixSolve(matrix* a, matrix* b);
+
+/**
+ * Compute the inverse of a square matrix with a temporary LU factorization.
+ * Function allocates memory for the matrix automatically.
+ * @param a Pointer to the square matrix
+ * @return Pointer to the inverse, or NULL if the matrix is singular or not square
+ */
+matrix* matrixInverse(matrix* a);
+
+/**
+ * Solve the least-squares problem min ||A * X - B|| with a temporary QR factorization,
+ * which is more accurate than the normal equations (Aᵀ * A) * X = Aᵀ * B.
+ * Use qrFactorCreate to solve repeatedly with the same A.
+ * Function allocates memory for the solution automatically.
+ * @param a Pointer to the matrix A (rows >= cols, full column rank)
+ * @param b Pointer to the right-hand sides (a->rows × k)
+ * @return Pointer to the solution X (a->cols × k), or NULL if A is rank deficient or dimensions mismatch
+ */
+matrix* matrixLeastSquares(matrix* a, matrix* b);
+
+#endif /* MATRIX_SOLVE_H */
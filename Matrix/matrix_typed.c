@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "matrix.h"
+#include "matrix_typed.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Number of columns of the result computed at once by the products,
+    so the panel of the second operand is reused from cache.
+*/
+#ifndef MATRIX_TYPED_NC
+#define MATRIX_TYPED_NC 256
+#endif
+
+/*
+    Products with fewer multiply-adds than this stay on the calling
+    thread, because waking the worker pool would cost more than it saves.
+*/
+#ifndef MATRIX_TYPED_PARALLEL_THRESHOLD
+#define MATRIX_TYPED_PARALLEL_THRESHOLD (128 * 128 * 128)
+#endif
+
+/*
+    Side of the square tiles used by the transposes.
+*/
+#ifndef MATRIX_TRANSPOSE_BLOCK
+#define MATRIX_TRANSPOSE_BLOCK 32
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/* Single precision: products accumulate in float, like the elements */
+#define MATRIX_GENERIC_TYPE float
+#define MATRIX_GENERIC_MATRIX matrixF32
+#define MATRIX_GENERIC_FN(name) matrixF32##name
+#define MATRIX_GENERIC_ACC float
+#define MATRIX_GENERIC_PRINT(v) fprintf(stdout, "%.2f ", (double)(v))
+#include "matrix_generic_impl.h"
+#undef MATRIX_GENERIC_TYPE
+#undef MATRIX_GENERIC_MATRIX
+#undef MATRIX_GENERIC_FN
+#undef MATRIX_GENERIC_ACC
+#undef MATRIX_GENERIC_PRINT
+
+/* 32-bit integers: products accumulate in 64 bits and are truncated on store */
+#define MATRIX_GENERIC_TYPE int32_t
+#define MATRIX_GENERIC_MATRIX matrixI32
+#define MATRIX_GENERIC_FN(name) matrixI32##name
+#define MATRIX_GENERIC_ACC int64_t
+#define MATRIX_GENERIC_PRINT(v) fprintf(stdout, "%d ", (int)(v))
+#include "matrix_generic_impl.h"
+#undef MATRIX_GENERIC_TYPE
+#undef MATRIX_GENERIC_MATRIX
+#undef MATRIX_GENERIC_FN
+#undef MATRIX_GENERIC_ACC
+#undef MATRIX_GENERIC_PRINT
+
+/*
+    Element conversions. Floating-point values are rounded to the nearest
+    integer and clamped to the int32 range; NaN becomes 0.
+*/
+#define CONVERT_PLAIN(v) (v)
+
+static int32_t convertToI32(double v){
+    if(isnan(v)){
+        return 0;
+    }
+    if(v >= (double)INT32_MAX){
+        return INT32_MAX;
+    }
+    if(v <= (double)INT32_MIN){
+        return INT32_MIN;
+    }
+    return (int32_t)lrint(v);
+}
+
+/*
+    Generate the Into and allocating variants of one conversion.
+*/
+#define DEFINE_MATRIX_CONVERSION(DstMatrix, DstType, dstCreateWith, name, SrcMatrix, convert) \
+    DstMatrix* name##Into(DstMatrix* dst, SrcMatrix* m){ \
+        if(m == NULL){ \
+            fprintf(stderr, "Matrix does not exist.\n"); \
+            return NULL; \
+        } \
+        if(dst == NULL){ \
+            fprintf(stderr, "Destination matrix does not exist.\n"); \
+            return NULL; \
+        } \
+        if(dst->rows != m->rows || dst->cols != m->cols){ \
+            fprintf(stderr, "Destination matrix has incompatible dimensions.\n"); \
+            return NULL; \
+        } \
+        for(int i = 0; i < m->rows; i++){ \
+            DstType* d = dst->data + MATRIX_ADDR(dst, i, 0); \
+            for(int j = 0; j < m->cols; j++){ \
+                d[j] = (DstType)convert(m->data[MATRIX_ADDR(m, i, j)]); \
+            } \
+        } \
+        return dst; \
+    } \
+    DstMatrix* name(SrcMatrix* m){ \
+        if(m == NULL){ \
+            fprintf(stderr, "Matrix does not exist.\n"); \
+            return NULL; \
+        } \
+        DstMatrix* result = dstCreateWith(m->rows, m->cols, MATRIX_CREATE_UNINITIALIZED); \
+        name##Into(result, m); \
+        return result; \
+    }
+
+DEFINE_MATRIX_CONVERSION(matrixF32, float, matrixF32CreateWith, matrixF32FromF64, matrix, CONVERT_PLAIN)
+DEFINE_MATRIX_CONVERSION(matrixF32, float, matrixF32CreateWith, matrixF32FromI32, matrixI32, CONVERT_PLAIN)
+DEFINE_MATRIX_CONVERSION(matrix, double, matrixCreateWith, matrixF64FromF32, matrixF32, CONVERT_PLAIN)
+DEFINE_MATRIX_CONVERSION(matrix, double, matrixCreateWith, matrixF64FromI32, matrixI32, CONVERT_PLAIN)
+DEFINE_MATRIX_CONVERSION(matrixI32, int32_t, matrixI32CreateWith, matrixI32FromF64, matrix, convertToI32)
+DEFINE_MATRIX_CONVERSION(matrixI32, int32_t, matrixI32CreateWith, matrixI32FromF32, matrixF32, convertToI32)
@@ -0,0 +1,134 @@
+#ifndef MATRIX_TYPED_H
+#define MATRIX_TYPED_H
+
+#include <stdint.h>
+#include "matrix.h"
+
+/**
+ * Double-precision matrices are the `matrix` type of matrix.h;
+ * this alias names them consistently with the other element types.
+ */
+typedef matrix matrixF64;
+
+/* Single-precision matrices: matrixF32 and the matrixF32... functions */
+#define MATRIX_GENERIC_TYPE float
+#define MATRIX_GENERIC_MATRIX matrixF32
+#define MATRIX_GENERIC_FN(name) matrixF32##name
+#include "matrix_generic.h"
+#undef MATRIX_GENERIC_TYPE
+#undef MATRIX_GENERIC_MATRIX
+#undef MATRIX_GENERIC_FN
+
+/* 32-bit integer matrices: matrixI32 and the matrixI32... functions */
+#define MATRIX_GENERIC_TYPE int32_t
+#define MATRIX_GENERIC_MATRIX matrixI32
+#define MATRIX_GENERIC_FN(name) matrixI32##name
+#include "matrix_generic.h"
+#undef MATRIX_GENERIC_TYPE
+#undef MATRIX_GENERIC_MATRIX
+#undef MATRIX_GENERIC_FN
+
+/*
+    Conversions between element types. Every conversion has an Into
+    variant writing into an existing matrix of the same dimensions, and
+    an allocating variant. Conversions to matrixI32 round to the nearest
+    integer; values outside the int32 range are clamped.
+*/
+
+/**
+ * Convert a double-precision matrix to single precision into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixF32* matrixF32FromF64Into(matrixF32* dst, matrix* m);
+
+/**
+ * Convert a double-precision matrix to single precision.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrixF32* matrixF32FromF64(matrix* m);
+
+/**
+ * Convert a 32-bit integer matrix to single precision into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixF32* matrixF32FromI32Into(matrixF32* dst, matrixI32* m);
+
+/**
+ * Convert a 32-bit integer matrix to single precision.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrixF32* matrixF32FromI32(matrixI32* m);
+
+/**
+ * Convert a single-precision matrix to double precision into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixF64FromF32Into(matrix* dst, matrixF32* m);
+
+/**
+ * Convert a single-precision matrix to double precision.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrix* matrixF64FromF32(matrixF32* m);
+
+/**
+ * Convert a 32-bit integer matrix to double precision into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrix* matrixF64FromI32Into(matrix* dst, matrixI32* m);
+
+/**
+ * Convert a 32-bit integer matrix to double precision.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrix* matrixF64FromI32(matrixI32* m);
+
+/**
+ * Convert a double-precision matrix to 32-bit integers into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixI32* matrixI32FromF64Into(matrixI32* dst, matrix* m);
+
+/**
+ * Convert a double-precision matrix to 32-bit integers.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrixI32* matrixI32FromF64(matrix* m);
+
+/**
+ * Convert a single-precision matrix to 32-bit integers into an existing matrix.
+ * @param dst Pointer to the destination matrix of the same dimensions
+ * @param m Pointer to the matrix to convert
+ * @return dst, or NULL if dimensions mismatch
+ */
+matrixI32* matrixI32FromF32Into(matrixI32* dst, matrixF32* m);
+
+/**
+ * Convert a single-precision matrix to 32-bit integers.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the matrix to convert
+ * @return Pointer to the converted matrix, or NULL if m is NULL
+ */
+matrixI32* matrixI32FromF32(matrixF32* m);
+
+#endif /* MATRIX_TYPED_H */
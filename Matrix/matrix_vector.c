@@ -0,0 +1,618 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include "matrix.h"
+#include "matrix_vector.h"
+#include "matrix_kernels.h"
+#include "thread_pool.h"
+
+/*
+    Products with fewer elements than this stay on the calling thread,
+    because waking the worker pool would cost more than it saves.
+*/
+#ifndef MATRIX_GEMV_PARALLEL_THRESHOLD
+#define MATRIX_GEMV_PARALLEL_THRESHOLD (256 * 1024)
+#endif
+
+/*
+    Number of elements of y updated at once by the transposed product,
+    so the block of y stays in L1 while the rows of the matrix stream by.
+*/
+#ifndef MATRIX_GEMV_COLUMN_BLOCK
+#define MATRIX_GEMV_COLUMN_BLOCK 1024
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Kernels of the vector operations for one instruction set.
+    dot4 computes the dot products of four rows of a (lda apart) with x,
+    axpy4 adds s[0] * row 0 + ... + s[3] * row 3 of a to y.
+*/
+typedef double (*vectorDotFn)(size_t n, const double* a, const double* b);
+typedef void (*vectorDot4Fn)(size_t n, const double* a, size_t lda, const double* x, double* out);
+typedef void (*vectorAxpy4Fn)(size_t n, const double* a, size_t lda, const double* s, double* y);
+
+typedef struct {
+    vectorDotFn dot;
+    vectorDot4Fn dot4;
+    vectorAxpy4Fn axpy4;
+} vectorKernels;
+
+/*
+    Portable kernels. The reductions keep four independent partial sums,
+    which hides the latency of the additions.
+*/
+static double vectorDotScalar(size_t n, const double* a, const double* b){
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for(; i < n; i++){
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void vectorDot4Scalar(size_t n, const double* a, size_t lda, const double* x, double* out){
+    const double* a0 = a;
+    const double* a1 = a + lda;
+    const double* a2 = a + 2 * lda;
+    const double* a3 = a + 3 * lda;
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for(size_t j = 0; j < n; j++){
+        s0 += a0[j] * x[j];
+        s1 += a1[j] * x[j];
+        s2 += a2[j] * x[j];
+        s3 += a3[j] * x[j];
+    }
+    out[0] = s0;
+    out[1] = s1;
+    out[2] = s2;
+    out[3] = s3;
+}
+
+MATRIX_VECTORIZE static void vectorAxpy4Scalar(size_t n, const double* a, size_t lda, const double* s, double* y){
+    const double* a0 = a;
+    const double* a1 = a + lda;
+    const double* a2 = a + 2 * lda;
+    const double* a3 = a + 3 * lda;
+    double s0 = s[0], s1 = s[1], s2 = s[2], s3 = s[3];
+    for(size_t j = 0; j < n; j++){
+        y[j] += s0 * a0[j] + s1 * a1[j] + s2 * a2[j] + s3 * a3[j];
+    }
+}
+
+#ifdef MATRIX_X86_SIMD
+/*
+    Sum of the four lanes of a register.
+*/
+__attribute__((target("avx")))
+static inline double horizontalSumAvx(__m256d v){
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+/*
+    AVX2/FMA kernels: four accumulators of four lanes for the dot product,
+    one accumulator per row for dot4, so every load of x feeds four FMAs.
+*/
+__attribute__((target("avx2,fma")))
+static double vectorDotAvx2(size_t n, const double* a, const double* b){
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), s3);
+    }
+    for(; i + 4 <= n; i += 4){
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+    }
+    double sum = horizontalSumAvx(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+    for(; i < n; i++){
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void vectorDot4Avx2(size_t n, const double* a, size_t lda, const double* x, double* out){
+    const double* a0 = a;
+    const double* a1 = a + lda;
+    const double* a2 = a + 2 * lda;
+    const double* a3 = a + 3 * lda;
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+    size_t j = 0;
+    for(; j + 4 <= n; j += 4){
+        __m256d xv = _mm256_loadu_pd(x + j);
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j), xv, s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j), xv, s1);
+        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j), xv, s2);
+        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j), xv, s3);
+    }
+    double r0 = horizontalSumAvx(s0), r1 = horizontalSumAvx(s1);
+    double r2 = horizontalSumAvx(s2), r3 = horizontalSumAvx(s3);
+    for(; j < n; j++){
+        r0 += a0[j] * x[j];
+        r1 += a1[j] * x[j];
+        r2 += a2[j] * x[j];
+        r3 += a3[j] * x[j];
+    }
+    out[0] = r0;
+    out[1] = r1;
+    out[2] = r2;
+    out[3] = r3;
+}
+
+__attribute__((target("avx2,fma")))
+static void vectorAxpy4Avx2(size_t n, const double* a, size_t lda, const double* s, double* y){
+    const double* a0 = a;
+    const double* a1 = a + lda;
+    const double* a2 = a + 2 * lda;
+    const double* a3 = a + 3 * lda;
+    __m256d v0 = _mm256_set1_pd(s[0]), v1 = _mm256_set1_pd(s[1]);
+    __m256d v2 = _mm256_set1_pd(s[2]), v3 = _mm256_set1_pd(s[3]);
+    size_t j = 0;
+    for(; j + 4 <= n; j += 4){
+        __m256d acc = _mm256_loadu_pd(y + j);
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(a0 + j), v0, acc);
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(a1 + j), v1, acc);
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(a2 + j), v2, acc);
+        acc = _mm256_fmadd_pd(_mm256_loadu_pd(a3 + j), v3, acc);
+        _mm256_storeu_pd(y + j, acc);
+    }
+    for(; j < n; j++){
+        y[j] += s[0] * a0[j] + s[1] * a1[j] + s[2] * a2[j] + s[3] * a3[j];
+    }
+}
+#endif
+
+/*
+    Pick the fastest kernels supported by the running CPU. The choice is made once.
+*/
+static const vectorKernels* vectorSelectKernels(){
+    static const vectorKernels scalar = {vectorDotScalar, vectorDot4Scalar, vectorAxpy4Scalar};
+    static const vectorKernels* selected = NULL;
+    if(selected != NULL){
+        return selected;
+    }
+    selected = &scalar;
+#ifdef MATRIX_X86_SIMD
+    static const vectorKernels avx2 = {vectorDotAvx2, vectorDot4Avx2, vectorAxpy4Avx2};
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        selected = &avx2;
+    }
+#endif
+    return selected;
+}
+
+vector* vectorCreate(int size){
+    // Check if size is positive
+    if(size < 0){
+        fprintf(stderr, "Vector size could not be negative.\n");
+        return NULL;
+    }
+    vector* v = malloc(sizeof(vector));
+    if(v == NULL){
+        allocationFailure();
+    }
+    v->size = size;
+    // aligned_alloc requires a size that is a multiple of the alignment
+    size_t bytes = ((size_t)size * sizeof(double) + MATRIX_ALIGNMENT - 1) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+    v->data = aligned_alloc(MATRIX_ALIGNMENT, bytes > 0 ? bytes : MATRIX_ALIGNMENT);
+    if(v->data == NULL){
+        allocationFailure();
+    }
+    memset(v->data, 0, bytes);
+    return v;
+}
+
+void vectorDelete(vector* v){
+    // Free the vector and its data array if it exists (non-null pointer).
+    if(v != NULL){
+        free(v->data);
+        free(v);
+    }
+    return;
+}
+
+double vectorGetValue(vector* v, int i){
+    // Check if vector exists (is not null)
+    if(v == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return -1;
+    }
+    // Check if index is in bounds
+    if(i < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return -1;
+    }
+    if(i >= v->size){
+        fprintf(stderr, "Index out of bounds.\n");
+        return -1;
+    }
+    return v->data[i];
+}
+
+void vectorSetValue(vector* v, int i, double value){
+    // Check if vector exists (is not null)
+    if(v == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return;
+    }
+    // Check if index is in bounds
+    if(i < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return;
+    }
+    if(i >= v->size){
+        fprintf(stderr, "Index out of bounds.\n");
+        return;
+    }
+    v->data[i] = value;
+}
+
+void vectorPrint(vector* v){
+    // Check if vector exists (is not null)
+    if(v == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return;
+    }
+    // Print vector to stdout
+    fprintf(stdout, "\n[ ");
+    for(int i = 0; i < v->size; i++){
+        fprintf(stdout, "%.2lf ", v->data[i]);
+    }
+    fprintf(stdout, "]\n");
+}
+
+double vectorDot(vector* x, vector* y){
+    // Check if vectors exist (are not null)
+    if(x == NULL || y == NULL){
+        fprintf(stderr, "At least one of the vectors isn't allocated.\n");
+        return NAN;
+    }
+    if(x->size != y->size){
+        fprintf(stderr, "Vector sizes are incompatible for this operation.\n");
+        return NAN;
+    }
+    return vectorSelectKernels()->dot(x->size, x->data, y->data);
+}
+
+vector* vectorAxpy(double alpha, vector* x, vector* y){
+    // Check if vectors exist (are not null)
+    if(x == NULL || y == NULL){
+        fprintf(stderr, "At least one of the vectors isn't allocated.\n");
+        return NULL;
+    }
+    if(x->size != y->size){
+        fprintf(stderr, "Vector sizes are incompatible for this operation.\n");
+        return NULL;
+    }
+    matrixElementwiseKernels()->axpy(y->size, x->data, alpha, y->data, y->data);
+    return y;
+}
+
+double vectorNorm(vector* x){
+    // Check if vector exists (is not null)
+    if(x == NULL){
+        fprintf(stderr, "Vector does not exist.\n");
+        return NAN;
+    }
+    // The plain sum of squares is exact enough unless it overflowed or lost precision to underflow
+    double sum = vectorSelectKernels()->dot(x->size, x->data, x->data);
+    if(isnan(sum) || (isfinite(sum) && sum >= DBL_MIN)){
+        return sqrt(sum);
+    }
+    // Otherwise scale the elements by the largest magnitude first
+    double scale = 0;
+    for(int i = 0; i < x->size; i++){
+        scale = fmax(scale, fabs(x->data[i]));
+    }
+    if(scale == 0 || isinf(scale)){
+        return scale;
+    }
+    sum = 0;
+    for(int i = 0; i < x->size; i++){
+        double t = x->data[i] / scale;
+        sum += t * t;
+    }
+    return scale * sqrt(sum);
+}
+
+/*
+    Static helper checking that a vector does not share memory with a matrix or another vector.
+*/
+static int vectorOverlapsRange(vector* v, const double* begin, const double* end){
+    return v->size > 0 && begin < end && v->data < end && begin < v->data + v->size;
+}
+
+static int vectorOverlapsMatrix(vector* v, matrix* m){
+    if(m->rows == 0 || m->cols == 0){
+        return 0;
+    }
+    return vectorOverlapsRange(v, m->data, m->data + MATRIX_ADDR(m, m->rows - 1, m->cols));
+}
+
+/*
+    Static helper validating the operands of a product y = op(a) * x.
+    Prints an error message and returns 0 if they are invalid.
+*/
+static int checkGemv(matrix* a, vector* x, vector* y, int xSize, int ySize){
+    // Check if operands exist (are not null)
+    if(a == NULL || x == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return 0;
+    }
+    if(y == NULL){
+        fprintf(stderr, "Destination vector does not exist.\n");
+        return 0;
+    }
+    // Verify that the dimensions meet the operation requirements.
+    if(x->size != xSize){
+        fprintf(stderr, "Matrix and vector dimensions are incompatible for this operation.\n");
+        return 0;
+    }
+    if(y->size != ySize){
+        fprintf(stderr, "Destination vector has incompatible dimensions.\n");
+        return 0;
+    }
+    // y is written while a and x are read
+    if(vectorOverlapsMatrix(y, a) || vectorOverlapsRange(y, x->data, x->data + x->size)){
+        fprintf(stderr, "Destination vector overlaps an operand.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+    Arguments shared by the tasks of a matrix-vector product.
+*/
+typedef struct {
+    const vectorKernels* kernels;
+    matrix* a;
+    const double* x;
+    double* y;
+    double alpha;
+    double beta;
+    double* partial;    /* Per-partition sums of the transposed product */
+    int parts;
+} gemvStep;
+
+/*
+    y = alpha * a * x + beta * y for groups of four rows [begin, end).
+*/
+static void gemvRowsTask(void* arg, int begin, int end){
+    gemvStep* step = arg;
+    matrix* a = step->a;
+    for(int g = begin; g < end; g++){
+        int i = g * 4;
+        int count = a->rows - i < 4 ? a->rows - i : 4;
+        double dots[4];
+        if(count == 4){
+            step->kernels->dot4(a->cols, a->data + MATRIX_ADDR(a, i, 0), a->stride, step->x, dots);
+        }
+        else{
+            for(int r = 0; r < count; r++){
+                dots[r] = step->kernels->dot(a->cols, a->data + MATRIX_ADDR(a, i + r, 0), step->x);
+            }
+        }
+        // With beta = 0 the previous y is ignored, even if it holds NaN
+        for(int r = 0; r < count; r++){
+            double* y = step->y + i + r;
+            *y = step->beta == 0 ? step->alpha * dots[r] : step->alpha * dots[r] + step->beta * *y;
+        }
+    }
+}
+
+/*
+    Add s * (rows [i0, i1) of a, columns [j0, j1)) to y, where the scale of row i is s * x[i].
+*/
+static void gemvTransposedRows(const vectorKernels* kernels, matrix* a, const double* x, double s, int i0, int i1, int j0, int j1, double* y){
+    int i = i0;
+    for(; i + 4 <= i1; i += 4){
+        double scales[4] = {s * x[i], s * x[i + 1], s * x[i + 2], s * x[i + 3]};
+        kernels->axpy4(j1 - j0, a->data + MATRIX_ADDR(a, i, j0), a->stride, scales, y);
+    }
+    for(; i < i1; i++){
+        matrixElementwiseKernels()->axpy(j1 - j0, a->data + MATRIX_ADDR(a, i, j0), s * x[i], y, y);
+    }
+}
+
+/*
+    y = alpha * aᵀ * x + beta * y for blocks of MATRIX_GEMV_COLUMN_BLOCK elements of y [begin, end).
+*/
+static void gemvColumnsTask(void* arg, int begin, int end){
+    gemvStep* step = arg;
+    matrix* a = step->a;
+    for(int b = begin; b < end; b++){
+        int j0 = b * MATRIX_GEMV_COLUMN_BLOCK;
+        int j1 = a->cols - j0 < MATRIX_GEMV_COLUMN_BLOCK ? a->cols : j0 + MATRIX_GEMV_COLUMN_BLOCK;
+        double* y = step->y + j0;
+        if(step->beta == 0){
+            memset(y, 0, sizeof(double) * (j1 - j0));
+        }
+        else if(step->beta != 1){
+            matrixElementwiseKernels()->mulScalar(j1 - j0, y, step->beta, y);
+        }
+        gemvTransposedRows(step->kernels, a, step->x, step->alpha, 0, a->rows, j0, j1, y);
+    }
+}
+
+/*
+    Partial sums of aᵀ * x over one partition of the rows per task [begin, end).
+*/
+static void gemvPartitionTask(void* arg, int begin, int end){
+    gemvStep* step = arg;
+    matrix* a = step->a;
+    for(int p = begin; p < end; p++){
+        int i0 = (int)((long long)a->rows * p / step->parts);
+        int i1 = (int)((long long)a->rows * (p + 1) / step->parts);
+        double* partial = step->partial + (size_t)p * a->cols;
+        memset(partial, 0, sizeof(double) * a->cols);
+        gemvTransposedRows(step->kernels, a, step->x, 1.0, i0, i1, 0, a->cols, partial);
+    }
+}
+
+vector* matrixGemv(double alpha, matrix* a, vector* x, double beta, vector* y){
+    if(!checkGemv(a, x, y, a == NULL ? 0 : a->cols, a == NULL ? 0 : a->rows)){
+        return NULL;
+    }
+    gemvStep step = {vectorSelectKernels(), a, x->data, y->data, alpha, beta, NULL, 0};
+    int groups = (a->rows + 3) / 4;
+    // Every group of rows is independent, so tall matrices split by rows
+    if((long long)a->rows * a->cols < MATRIX_GEMV_PARALLEL_THRESHOLD){
+        gemvRowsTask(&step, 0, groups);
+    }
+    else{
+        int grain = 4096 / (a->cols > 0 ? a->cols : 1);
+        matrixParallelFor(groups, grain, gemvRowsTask, &step);
+    }
+    return y;
+}
+
+vector* matrixGemvTransposed(double alpha, matrix* a, vector* x, double beta, vector* y){
+    if(!checkGemv(a, x, y, a == NULL ? 0 : a->rows, a == NULL ? 0 : a->cols)){
+        return NULL;
+    }
+    gemvStep step = {vectorSelectKernels(), a, x->data, y->data, alpha, beta, NULL, 0};
+    int blocks = (a->cols + MATRIX_GEMV_COLUMN_BLOCK - 1) / MATRIX_GEMV_COLUMN_BLOCK;
+    int threads = matrixGetNumThreads();
+    if((long long)a->rows * a->cols < MATRIX_GEMV_PARALLEL_THRESHOLD || threads == 1){
+        gemvColumnsTask(&step, 0, blocks);
+        return y;
+    }
+    // Wide matrices split y into blocks, each computed from all rows
+    if(blocks >= threads){
+        matrixParallelFor(blocks, 1, gemvColumnsTask, &step);
+        return y;
+    }
+    // Tall matrices split the rows, sum them per partition and reduce the partitions
+    step.parts = threads;
+    step.partial = malloc(sizeof(double) * threads * a->cols);
+    if(step.partial == NULL){
+        allocationFailure();
+    }
+    matrixParallelFor(step.parts, 1, gemvPartitionTask, &step);
+    for(int j = 0; j < a->cols; j++){
+        double sum = 0;
+        for(int p = 0; p < step.parts; p++){
+            sum += step.partial[(size_t)p * a->cols + j];
+        }
+        y->data[j] = beta == 0 ? alpha * sum : alpha * sum + beta * y->data[j];
+    }
+    free(step.partial);
+    return y;
+}
+
+vector* matrixMulVector(matrix* a, vector* x){
+    // Check if operands exist (are not null)
+    if(a == NULL || x == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return NULL;
+    }
+    if(x->size != a->cols){
+        fprintf(stderr, "Matrix and vector dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    vector* result = vectorCreate(a->rows);
+    matrixGemv(1.0, a, x, 0.0, result);
+    return result;
+}
+
+vector* matrixTransposeMulVector(matrix* a, vector* x){
+    // Check if operands exist (are not null)
+    if(a == NULL || x == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return NULL;
+    }
+    if(x->size != a->rows){
+        fprintf(stderr, "Matrix and vector dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    vector* result = vectorCreate(a->cols);
+    matrixGemvTransposed(1.0, a, x, 0.0, result);
+    return result;
+}
+
+vector* matrixPowMulVectorInto(vector* y, matrix* a, long long k, vector* x){
+    // Check if operands exist (are not null)
+    if(a == NULL || x == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return NULL;
+    }
+    if(y == NULL){
+        fprintf(stderr, "Destination vector does not exist.\n");
+        return NULL;
+    }
+    // Verify that the dimensions meet the operation requirements.
+    if(a->rows != a->cols || x->size != a->cols){
+        fprintf(stderr, "Matrix and vector dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(y->size != a->rows){
+        fprintf(stderr, "Destination vector has incompatible dimensions.\n");
+        return NULL;
+    }
+    if(k < 0){
+        fprintf(stderr, "Exponent could not be negative.\n");
+        return NULL;
+    }
+    if(vectorOverlapsMatrix(y, a)){
+        fprintf(stderr, "Destination vector overlaps an operand.\n");
+        return NULL;
+    }
+    // Start in the vector that makes the last step land in y
+    vector* work = vectorCreate(y->size);
+    vector* current = k % 2 == 0 ? y : work;
+    vector* next = k % 2 == 0 ? work : y;
+    if(current->data != x->data){
+        memcpy(current->data, x->data, sizeof(double) * x->size);
+    }
+    for(long long step = 0; step < k; step++){
+        matrixGemv(1.0, a, current, 0.0, next);
+        vector* tmp = current;
+        current = next;
+        next = tmp;
+    }
+    vectorDelete(work);
+    return y;
+}
+
+vector* matrixPowMulVector(matrix* a, long long k, vector* x){
+    // Check if operands exist (are not null)
+    if(a == NULL || x == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return NULL;
+    }
+    // Check the arguments before allocating
+    if(a->rows != a->cols || x->size != a->cols){
+        fprintf(stderr, "Matrix and vector dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(k < 0){
+        fprintf(stderr, "Exponent could not be negative.\n");
+        return NULL;
+    }
+    vector* result = vectorCreate(a->rows);
+    matrixPowMulVectorInto(result, a, k, x);
+    return result;
+}
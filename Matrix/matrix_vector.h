@@ -0,0 +1,141 @@
+#ifndef MATRIX_VECTOR_H
+#define MATRIX_VECTOR_H
+
+#include "matrix.h"
+
+/**
+ * Structure representing a dense vector of doubles.
+ */
+typedef struct {
+    int size;       /** Number of elements */
+    double* data;   /** Pointer to the elements (64-byte aligned) */
+} vector;
+
+/**
+ * Create a vector of the given size, filled with zeros.
+ * Function allocates memory for the vector automatically.
+ * @param size Number of elements
+ * @return Pointer to the newly created vector, or NULL if size is negative
+ */
+vector* vectorCreate(int size);
+
+/**
+ * Free the memory associated with the vector.
+ * @param v Pointer to the vector to delete
+ */
+void vectorDelete(vector* v);
+
+/**
+ * Get the value at position i.
+ * @param v Pointer to the vector
+ * @param i Index
+ * @return The value stored at position i, or -1 on invalid arguments
+ */
+double vectorGetValue(vector* v, int i);
+
+/**
+ * Set the value at position i.
+ * @param v Pointer to the vector
+ * @param i Index
+ * @param value Value to set at i
+ */
+void vectorSetValue(vector* v, int i, double value);
+
+/**
+ * Print the vector to stdout.
+ * @param v Pointer to the vector
+ */
+void vectorPrint(vector* v);
+
+/**
+ * Compute the dot product of two vectors of the same size.
+ * @param x Pointer to the first vector
+ * @param y Pointer to the second vector
+ * @return x · y, or NaN if sizes mismatch
+ */
+double vectorDot(vector* x, vector* y);
+
+/**
+ * Add a multiple of one vector to another in place (y = alpha * x + y).
+ * @param alpha Scale of x
+ * @param x Pointer to the vector to add
+ * @param y Pointer to the vector to update
+ * @return y, or NULL if sizes mismatch
+ */
+vector* vectorAxpy(double alpha, vector* x, vector* y);
+
+/**
+ * Compute the Euclidean norm of a vector, without overflow or
+ * underflow for elements of extreme magnitude.
+ * @param x Pointer to the vector
+ * @return ||x||, or NaN if x is NULL
+ */
+double vectorNorm(vector* x);
+
+/**
+ * Compute y = alpha * a * x + beta * y in place.
+ * When beta is 0, y is only written, so its previous contents may be anything.
+ * Tall matrices are processed by multiple threads; y must not overlap a or x.
+ * @param alpha Scale of the product
+ * @param a Pointer to the matrix (rows × cols)
+ * @param x Pointer to the vector of cols elements
+ * @param beta Scale of the previous value of y
+ * @param y Pointer to the vector of rows elements
+ * @return y, or NULL if dimensions mismatch
+ */
+vector* matrixGemv(double alpha, matrix* a, vector* x, double beta, vector* y);
+
+/**
+ * Compute y = alpha * aᵀ * x + beta * y in place, without forming the transpose.
+ * When beta is 0, y is only written, so its previous contents may be anything.
+ * Large matrices are processed by multiple threads; y must not overlap a or x.
+ * @param alpha Scale of the product
+ * @param a Pointer to the matrix (rows × cols)
+ * @param x Pointer to the vector of rows elements
+ * @param beta Scale of the previous value of y
+ * @param y Pointer to the vector of cols elements
+ * @return y, or NULL if dimensions mismatch
+ */
+vector* matrixGemvTransposed(double alpha, matrix* a, vector* x, double beta, vector* y);
+
+/**
+ * Multiply a matrix by a vector (a × x).
+ * Function allocates memory for the vector automatically.
+ * @param a Pointer to the matrix (rows × cols)
+ * @param x Pointer to the vector of cols elements
+ * @return Pointer to the resulting vector of rows elements, or NULL if dimensions mismatch
+ */
+vector* matrixMulVector(matrix* a, vector* x);
+
+/**
+ * Multiply the transpose of a matrix by a vector (aᵀ × x).
+ * Function allocates memory for the vector automatically.
+ * @param a Pointer to the matrix (rows × cols)
+ * @param x Pointer to the vector of rows elements
+ * @return Pointer to the resulting vector of cols elements, or NULL if dimensions mismatch
+ */
+vector* matrixTransposeMulVector(matrix* a, vector* x);
+
+/**
+ * Apply a square matrix k times to a vector (y = a^k * x) without forming a^k,
+ * by k matrix-vector products alternating between y and one work vector.
+ * y may be x.
+ * @param y Pointer to the destination vector of a->rows elements
+ * @param a Pointer to the square matrix
+ * @param k Number of steps (a^0 * x is x)
+ * @param x Pointer to the vector of a->cols elements
+ * @return y, or NULL if dimensions mismatch or k is negative
+ */
+vector* matrixPowMulVectorInto(vector* y, matrix* a, long long k, vector* x);
+
+/**
+ * Apply a square matrix k times to a vector (a^k * x) without forming a^k.
+ * Function allocates memory for the vector automatically.
+ * @param a Pointer to the square matrix
+ * @param k Number of steps (a^0 * x is x)
+ * @param x Pointer to the vector of a->cols elements
+ * @return Pointer to the resulting vector, or NULL if dimensions mismatch or k is negative
+ */
+vector* matrixPowMulVector(matrix* a, long long k, vector* x);
+
+#endif /* MATRIX_VECTOR_H */
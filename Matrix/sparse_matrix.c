@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "matrix.h"
+#include "sparse_matrix.h"
+#include "thread_pool.h"
+
+/*
+    Products with fewer stored elements (nnz, or nnz * columns of the
+    dense operand) than this stay on the calling thread, because waking
+    the worker pool would cost more than it saves.
+*/
+#ifndef SPARSE_PARALLEL_THRESHOLD
+#define SPARSE_PARALLEL_THRESHOLD (64 * 1024)
+#endif
+
+/*
+    Number of rows handed to a worker at once by the parallel kernels.
+*/
+#ifndef SPARSE_ROW_GRAIN
+#define SPARSE_ROW_GRAIN 64
+#endif
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Allocate a sparse matrix with room for `nnz` elements.
+    rowPtr is zero-filled; colIdx and values are left uninitialized.
+*/
+static sparseMatrix* sparseMatrixAllocate(int rows, int cols, int nnz){
+    sparseMatrix* s = malloc(sizeof(sparseMatrix));
+    if(s == NULL){
+        allocationFailure();
+    }
+    s->rows = rows;
+    s->cols = cols;
+    s->nnz = nnz;
+    s->rowPtr = calloc((size_t)rows + 1, sizeof(int));
+    // malloc(0) may return NULL, so always ask for at least one element
+    s->colIdx = malloc((nnz > 0 ? (size_t)nnz : 1) * sizeof(int));
+    s->values = malloc((nnz > 0 ? (size_t)nnz : 1) * sizeof(double));
+    if(s->rowPtr == NULL || s->colIdx == NULL || s->values == NULL){
+        allocationFailure();
+    }
+    return s;
+}
+
+sparseMatrix* sparseMatrixFromDense(matrix* m){
+    // Check if matrix exists (is not null)
+    if(m == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // First pass counts the nonzero elements, so the arrays are allocated once
+    long long nnz = 0;
+    for(int i = 0; i < m->rows; i++){
+        const double* row = m->data + MATRIX_ADDR(m, i, 0);
+        for(int j = 0; j < m->cols; j++){
+            nnz += row[j] != 0.0;
+        }
+    }
+    if(nnz > INT_MAX){
+        fprintf(stderr, "Sparse matrix has too many nonzero elements.\n");
+        return NULL;
+    }
+    sparseMatrix* s = sparseMatrixAllocate(m->rows, m->cols, (int)nnz);
+    // Second pass copies them row by row
+    int k = 0;
+    for(int i = 0; i < m->rows; i++){
+        const double* row = m->data + MATRIX_ADDR(m, i, 0);
+        for(int j = 0; j < m->cols; j++){
+            if(row[j] != 0.0){
+                s->colIdx[k] = j;
+                s->values[k] = row[j];
+                k++;
+            }
+        }
+        s->rowPtr[i + 1] = k;
+    }
+    return s;
+}
+
+sparseMatrix* sparseMatrixFromTriplets(int rows, int cols, int count, const int* rowIdx, const int* colIdx, const double* values){
+    if(rows < 0 || cols < 0 || count < 0){
+        fprintf(stderr, "Matrix dimensions could not be negative.\n");
+        return NULL;
+    }
+    if(count > 0 && (rowIdx == NULL || colIdx == NULL || values == NULL)){
+        fprintf(stderr, "Triplet arrays do not exist.\n");
+        return NULL;
+    }
+    for(int t = 0; t < count; t++){
+        if(rowIdx[t] < 0 || rowIdx[t] >= rows || colIdx[t] < 0 || colIdx[t] >= cols){
+            fprintf(stderr, "Index out of bounds.\n");
+            return NULL;
+        }
+    }
+    sparseMatrix* s = sparseMatrixAllocate(rows, cols, count);
+    // Counting sort by row: count the triplets of every row, then turn the counts into offsets
+    for(int t = 0; t < count; t++){
+        s->rowPtr[rowIdx[t] + 1]++;
+    }
+    for(int i = 0; i < rows; i++){
+        s->rowPtr[i + 1] += s->rowPtr[i];
+    }
+    // A stable counting sort by column first orders the triplets by column...
+    int* colStart = calloc((size_t)cols + 1, sizeof(int));
+    int* order = malloc((count > 0 ? (size_t)count : 1) * sizeof(int));
+    int* next = malloc(((size_t)rows + 1) * sizeof(int));
+    if(colStart == NULL || order == NULL || next == NULL){
+        allocationFailure();
+    }
+    for(int t = 0; t < count; t++){
+        colStart[colIdx[t] + 1]++;
+    }
+    for(int j = 0; j < cols; j++){
+        colStart[j + 1] += colStart[j];
+    }
+    for(int t = 0; t < count; t++){
+        order[colStart[colIdx[t]]++] = t;
+    }
+    // ...so distributing them to their rows in that order leaves every row sorted by column,
+    // with duplicates in input order, in O(count + rows + cols) whatever the row lengths
+    memcpy(next, s->rowPtr, ((size_t)rows + 1) * sizeof(int));
+    for(int o = 0; o < count; o++){
+        int t = order[o];
+        int k = next[rowIdx[t]]++;
+        s->colIdx[k] = colIdx[t];
+        s->values[k] = values[t];
+    }
+    free(colStart);
+    free(order);
+    // Merge duplicates
+    int nnz = 0;
+    for(int i = 0; i < rows; i++){
+        int begin = s->rowPtr[i], end = s->rowPtr[i + 1];
+        // Compact the row in place, rows before it have already been moved down
+        s->rowPtr[i] = nnz;
+        for(int k = begin; k < end; k++){
+            if(nnz > s->rowPtr[i] && s->colIdx[nnz - 1] == s->colIdx[k]){
+                s->values[nnz - 1] += s->values[k];
+            }
+            else{
+                s->colIdx[nnz] = s->colIdx[k];
+                s->values[nnz] = s->values[k];
+                nnz++;
+            }
+        }
+    }
+    s->rowPtr[rows] = nnz;
+    s->nnz = nnz;
+    free(next);
+    return s;
+}
+
+matrix* sparseMatrixToDense(sparseMatrix* s){
+    // Check if matrix exists (is not null)
+    if(s == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return NULL;
+    }
+    // matrixCreate fills the matrix with zeros, only stored elements have to be written
+    matrix* m = matrixCreate(s->rows, s->cols);
+    for(int i = 0; i < s->rows; i++){
+        double* row = m->data + MATRIX_ADDR(m, i, 0);
+        for(int k = s->rowPtr[i]; k < s->rowPtr[i + 1]; k++){
+            row[s->colIdx[k]] = s->values[k];
+        }
+    }
+    return m;
+}
+
+void sparseMatrixDelete(sparseMatrix* s){
+    // Free the matrix and its arrays if it exists (non-null pointer).
+    if(s != NULL){
+        free(s->rowPtr);
+        free(s->colIdx);
+        free(s->values);
+        free(s);
+    }
+    return;
+}
+
+double sparseMatrixGetValue(sparseMatrix* s, int i, int j){
+    // Check if matrix exists (is not null)
+    if(s == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return -1;
+    }
+    // Check if index is positive
+    if(i < 0 || j < 0){
+        fprintf(stderr, "Index could not be negative.\n");
+        return -1;
+    }
+    // Check if index matches the matrix dimensions
+    if(i >= s->rows || j >= s->cols){
+        fprintf(stderr, "Index out of bounds.\n");
+        return -1;
+    }
+    // Columns of a row are sorted, so binary search them
+    int lo = s->rowPtr[i], hi = s->rowPtr[i + 1] - 1;
+    while(lo <= hi){
+        int mid = lo + (hi - lo) / 2;
+        if(s->colIdx[mid] == j){
+            return s->values[mid];
+        }
+        if(s->colIdx[mid] < j){
+            lo = mid + 1;
+        }
+        else{
+            hi = mid - 1;
+        }
+    }
+    return 0.0;
+}
+
+/*
+    Arguments shared by the row tasks of a sparse product.
+    For SpMV `n` is 1 and x/y are vectors.
+*/
+typedef struct {
+    const sparseMatrix* s;
+    const double* x;    /* Dense operand, ldx doubles per row */
+    int ldx;
+    double* y;          /* Output, ldy doubles per row */
+    int ldy;
+    int n;              /* Number of columns of the dense operand */
+} sparseProduct;
+
+/*
+    Compute y[i] = row i of s times x for the rows [begin, end).
+*/
+static void sparseMulVectorTask(void* arg, int begin, int end){
+    sparseProduct* p = arg;
+    const int* rowPtr = p->s->rowPtr;
+    const int* colIdx = p->s->colIdx;
+    const double* values = p->s->values;
+    for(int i = begin; i < end; i++){
+        double sum = 0.0;
+        for(int k = rowPtr[i]; k < rowPtr[i + 1]; k++){
+            sum += values[k] * p->x[colIdx[k]];
+        }
+        p->y[i] = sum;
+    }
+}
+
+/*
+    Compute the rows [begin, end) of y = s * x. Every stored element
+    scales one row of x, so both x and y are read sequentially.
+*/
+static void sparseMulDenseTask(void* arg, int begin, int end){
+    sparseProduct* p = arg;
+    for(int i = begin; i < end; i++){
+        double* yi = p->y + (size_t)i * p->ldy;
+        memset(yi, 0, (size_t)p->n * sizeof(double));
+        for(int k = p->s->rowPtr[i]; k < p->s->rowPtr[i + 1]; k++){
+            double v = p->s->values[k];
+            const double* xk = p->x + (size_t)p->s->colIdx[k] * p->ldx;
+            for(int j = 0; j < p->n; j++){
+                yi[j] += v * xk[j];
+            }
+        }
+    }
+}
+
+double* sparseMatrixMulVector(sparseMatrix* s, const double* x, double* y){
+    // Check if matrix and vectors exist (are not null)
+    if(s == NULL || x == NULL || y == NULL){
+        fprintf(stderr, "Matrix or vector does not exist.\n");
+        return NULL;
+    }
+    // The product reads x while writing y, so they cannot share memory.
+    if(x < y + s->rows && y < x + s->cols){
+        fprintf(stderr, "Output vector cannot overlap the input vector.\n");
+        return NULL;
+    }
+    sparseProduct p = {s, x, 1, y, 1, 1};
+    if(s->nnz < SPARSE_PARALLEL_THRESHOLD){
+        sparseMulVectorTask(&p, 0, s->rows);
+    }
+    else{
+        matrixParallelFor(s->rows, SPARSE_ROW_GRAIN, sparseMulVectorTask, &p);
+    }
+    return y;
+}
+
+matrix* sparseMatrixMulDenseInto(matrix* dst, sparseMatrix* s, matrix* m){
+    // Check if matrices exist (are not null)
+    if(s == NULL || m == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(s->cols != m->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    if(dst == NULL){
+        fprintf(stderr, "Destination matrix does not exist.\n");
+        return NULL;
+    }
+    if(dst->rows != s->rows || dst->cols != m->cols){
+        fprintf(stderr, "Destination matrix has incompatible dimensions.\n");
+        return NULL;
+    }
+    // The product reads m while writing dst, so they cannot share memory.
+    if(matrixOverlaps(dst, m)){
+        fprintf(stderr, "Destination of a matrix product cannot be one of its operands.\n");
+        return NULL;
+    }
+    sparseProduct p = {s, m->data, m->stride, dst->data, dst->stride, m->cols};
+    if((long long)s->nnz * m->cols < SPARSE_PARALLEL_THRESHOLD){
+        sparseMulDenseTask(&p, 0, s->rows);
+    }
+    else{
+        matrixParallelFor(s->rows, SPARSE_ROW_GRAIN, sparseMulDenseTask, &p);
+    }
+    return dst;
+}
+
+matrix* sparseMatrixMulDense(sparseMatrix* s, matrix* m){
+    // Check if matrices exist (are not null)
+    if(s == NULL || m == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(s->cols != m->rows){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    // Create a new matrix instance; every element is written below, so it is not zeroed.
+    matrix* result = matrixCreateWith(s->rows, m->cols, MATRIX_CREATE_UNINITIALIZED);
+
+    // Compute the product into the new matrix.
+    sparseMatrixMulDenseInto(result, s, m);
+
+    // Return pointer to a new matrix
+    return result;
+}
+
+sparseMatrix* sparseMatrixAdd(sparseMatrix* s1, sparseMatrix* s2){
+    // Check if matrices exist (are not null)
+    if(s1 == NULL || s2 == NULL){
+        fprintf(stderr, "At least one of the matrices isn't allocated.\n");
+        return NULL;
+    }
+    // Verify that matrix dimensions meet the operation requirements.
+    if(s1->rows != s2->rows || s1->cols != s2->cols){
+        fprintf(stderr, "Matrix dimensions are incompatible for this operation.\n");
+        return NULL;
+    }
+    // The union of both patterns has at most nnz1 + nnz2 elements, and no more than the matrix has
+    long long capacity = (long long)s1->nnz + s2->nnz;
+    if(capacity > (long long)s1->rows * s1->cols){
+        capacity = (long long)s1->rows * s1->cols;
+    }
+    if(capacity > INT_MAX){
+        fprintf(stderr, "Sparse matrix has too many nonzero elements.\n");
+        return NULL;
+    }
+    sparseMatrix* result = sparseMatrixAllocate(s1->rows, s1->cols, (int)capacity);
+    int nnz = 0;
+    for(int i = 0; i < s1->rows; i++){
+        // Merge the two sorted rows
+        int a = s1->rowPtr[i], aEnd = s1->rowPtr[i + 1];
+        int b = s2->rowPtr[i], bEnd = s2->rowPtr[i + 1];
+        while(a < aEnd || b < bEnd){
+            if(b >= bEnd || (a < aEnd && s1->colIdx[a] < s2->colIdx[b])){
+                result->colIdx[nnz] = s1->colIdx[a];
+                result->values[nnz] = s1->values[a++];
+            }
+            else if(a >= aEnd || s2->colIdx[b] < s1->colIdx[a]){
+                result->colIdx[nnz] = s2->colIdx[b];
+                result->values[nnz] = s2->values[b++];
+            }
+            else{
+                result->colIdx[nnz] = s1->colIdx[a];
+                result->values[nnz] = s1->values[a++] + s2->values[b++];
+            }
+            nnz++;
+        }
+        result->rowPtr[i + 1] = nnz;
+    }
+    result->nnz = nnz;
+    return result;
+}
+
+void sparseMatrixPrint(sparseMatrix* s){
+    // Check if matrix exists (is not null)
+    if(s == NULL){
+        fprintf(stderr, "Matrix does not exist.\n");
+        return;
+    }
+    // Print every stored element as (row, column) value
+    fprintf(stdout, "\n%d x %d, %d stored elements\n", s->rows, s->cols, s->nnz);
+    for(int i = 0; i < s->rows; i++){
+        for(int k = s->rowPtr[i]; k < s->rowPtr[i + 1]; k++){
+            fprintf(stdout, "(%d, %d) %.2lf\n", i, s->colIdx[k], s->values[k]);
+        }
+    }
+}
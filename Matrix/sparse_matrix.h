@@ -0,0 +1,113 @@
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include "matrix.h"
+
+/**
+ * Structure representing a sparse matrix in Compressed Sparse Row (CSR) format.
+ *
+ * The nonzero elements of row i are stored at positions
+ * rowPtr[i] .. rowPtr[i + 1] - 1 of `colIdx` and `values`,
+ * ordered by increasing column index.
+ */
+typedef struct {
+    int rows;       /** Number of rows in the matrix */
+    int cols;       /** Number of columns in the matrix */
+    int nnz;        /** Number of stored (nonzero) elements */
+    int* rowPtr;    /** Offsets of the rows in colIdx/values (rows + 1 entries) */
+    int* colIdx;    /** Column index of every stored element */
+    double* values; /** Value of every stored element */
+} sparseMatrix;
+
+/**
+ * Create a sparse matrix from a dense matrix, storing only its nonzero elements.
+ * Function allocates memory for the matrix automatically.
+ * @param m Pointer to the dense matrix
+ * @return Pointer to the newly created sparse matrix, or NULL if m is NULL or has more than INT_MAX nonzero elements
+ */
+sparseMatrix* sparseMatrixFromDense(matrix* m);
+
+/**
+ * Create a sparse matrix from (row, column, value) triplets in any order.
+ * Values of duplicate positions are summed. Runs in time linear in the number
+ * of triplets and the dimensions, whatever the lengths of the rows.
+ * Function allocates memory for the matrix automatically.
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param count Number of triplets
+ * @param rowIdx Row index of every triplet
+ * @param colIdx Column index of every triplet
+ * @param values Value of every triplet
+ * @return Pointer to the newly created sparse matrix, or NULL if an index is out of bounds
+ */
+sparseMatrix* sparseMatrixFromTriplets(int rows, int cols, int count, const int* rowIdx, const int* colIdx, const double* values);
+
+/**
+ * Convert a sparse matrix to a dense matrix.
+ * Function allocates memory for the matrix automatically.
+ * @param s Pointer to the sparse matrix
+ * @return Pointer to the newly created dense matrix, or NULL if s is NULL
+ */
+matrix* sparseMatrixToDense(sparseMatrix* s);
+
+/**
+ * Free the memory associated with the sparse matrix.
+ * @param s Pointer to the sparse matrix to delete
+ */
+void sparseMatrixDelete(sparseMatrix* s);
+
+/**
+ * Get the value at position (i, j) in the sparse matrix.
+ * @param s Pointer to the sparse matrix
+ * @param i Row index
+ * @param j Column index
+ * @return The value at (i, j) (0 if not stored), or -1 on invalid arguments
+ */
+double sparseMatrixGetValue(sparseMatrix* s, int i, int j);
+
+/**
+ * Multiply a sparse matrix by a dense vector (y = s × x).
+ * Rows are processed in parallel for large matrices.
+ * @param s Pointer to the sparse matrix
+ * @param x Input vector of s->cols elements
+ * @param y Output vector of s->rows elements (must not overlap x)
+ * @return y, or NULL on invalid arguments
+ */
+double* sparseMatrixMulVector(sparseMatrix* s, const double* x, double* y);
+
+/**
+ * Multiply a sparse matrix by a dense matrix (s × m) into an existing matrix.
+ * Rows are processed in parallel for large matrices.
+ * @param dst Pointer to the destination matrix (s->rows × m->cols), must not overlap m
+ * @param s Pointer to the sparse matrix
+ * @param m Pointer to the dense matrix
+ * @return dst, or NULL if dimensions are invalid
+ */
+matrix* sparseMatrixMulDenseInto(matrix* dst, sparseMatrix* s, matrix* m);
+
+/**
+ * Multiply a sparse matrix by a dense matrix (s × m).
+ * Function allocates memory for the matrix automatically.
+ * @param s Pointer to the sparse matrix
+ * @param m Pointer to the dense matrix
+ * @return Pointer to the resulting dense matrix, or NULL if dimensions are invalid
+ */
+matrix* sparseMatrixMulDense(sparseMatrix* s, matrix* m);
+
+/**
+ * Add two sparse matrices (s1 + s2).
+ * The result stores the union of both sparsity patterns.
+ * Function allocates memory for the matrix automatically.
+ * @param s1 Pointer to the first sparse matrix
+ * @param s2 Pointer to the second sparse matrix
+ * @return Pointer to the resulting sparse matrix, or NULL if dimensions mismatch or the sum could exceed INT_MAX elements
+ */
+sparseMatrix* sparseMatrixAdd(sparseMatrix* s1, sparseMatrix* s2);
+
+/**
+ * Print the stored elements of the sparse matrix to stdout.
+ * @param s Pointer to the sparse matrix to print
+ */
+void sparseMatrixPrint(sparseMatrix* s);
+
+#endif /* SPARSE_MATRIX_H */
@@ -0,0 +1,260 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "matrix.h"
+#include "thread_pool.h"
+
+/*
+    Structure holding the persistent worker threads and the job
+    they are currently working on. The calling thread always takes
+    part in a job, so `workers` is one less than the thread count.
+*/
+typedef struct {
+    pthread_t* threads;         /* Worker thread handles */
+    int workers;                /* Number of worker threads */
+    pthread_mutex_t lock;       /* Protects the fields below */
+    pthread_cond_t wake;        /* Signalled when a new job is published */
+    pthread_cond_t done;        /* Signalled when the last worker finishes */
+    unsigned long generation;   /* Incremented for every new job */
+    int running;                /* Workers still busy with the current job */
+    int shutdown;               /* Set to stop all workers */
+    matrixTaskFn fn;            /* Current job */
+    void* arg;
+    int count;
+    int grain;
+    atomic_int next;            /* Next unclaimed work item */
+} threadPool;
+
+// Serializes jobs and pool (re)configuration
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static threadPool* pool = NULL;
+// Read without the lock, so callers never wait for a running job; 0 until first used
+static atomic_int threadCount = 0;
+// Set in worker threads and during a job, so nested calls run serially
+static _Thread_local int insideTask = 0;
+
+/*
+    Handle memory allocation failure by printing an error and exiting.
+*/
+_Noreturn static void allocationFailure(){
+    fprintf(stderr, "There is not enough memory available.\n");
+    exit(EXIT_FAILURE);
+}
+
+/*
+    Cleanup handler registered with matrixAtThreadExit, in a per-thread list.
+*/
+typedef struct threadExitHandler {
+    void (*fn)(void* arg);
+    void* arg;
+    struct threadExitHandler* next;
+} threadExitHandler;
+
+// Key whose destructor runs the handler list of an exiting thread
+static pthread_key_t exitKey;
+static pthread_once_t exitKeyOnce = PTHREAD_ONCE_INIT;
+
+static void runExitHandlers(void* list){
+    threadExitHandler* h = list;
+    while(h != NULL){
+        threadExitHandler* next = h->next;
+        h->fn(h->arg);
+        free(h);
+        h = next;
+    }
+}
+
+static void createExitKey(){
+    if(pthread_key_create(&exitKey, runExitHandlers) != 0){
+        fprintf(stderr, "Could not create thread exit key.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void matrixAtThreadExit(void (*fn)(void* arg), void* arg){
+    pthread_once(&exitKeyOnce, createExitKey);
+    threadExitHandler* h = malloc(sizeof(threadExitHandler));
+    if(h == NULL){
+        allocationFailure();
+    }
+    h->fn = fn;
+    h->arg = arg;
+    // New handlers go first, so they run before the older ones
+    h->next = pthread_getspecific(exitKey);
+    if(pthread_setspecific(exitKey, h) != 0){
+        allocationFailure();
+    }
+}
+
+/*
+    Claim chunks of the current job until none are left.
+*/
+static void runChunks(threadPool* p){
+    for(;;){
+        int begin = atomic_fetch_add(&p->next, p->grain);
+        if(begin >= p->count){
+            return;
+        }
+        int end = begin + p->grain < p->count ? begin + p->grain : p->count;
+        p->fn(p->arg, begin, end);
+    }
+}
+
+static void* workerMain(void* arg){
+    threadPool* p = arg;
+    unsigned long seen = 0;
+    insideTask = 1;
+    for(;;){
+        // Sleep until a new job is published or the pool shuts down
+        pthread_mutex_lock(&p->lock);
+        while(!p->shutdown && p->generation == seen){
+            pthread_cond_wait(&p->wake, &p->lock);
+        }
+        if(p->shutdown){
+            pthread_mutex_unlock(&p->lock);
+            return NULL;
+        }
+        seen = p->generation;
+        pthread_mutex_unlock(&p->lock);
+
+        runChunks(p);
+
+        // Report completion, the last worker wakes the caller
+        pthread_mutex_lock(&p->lock);
+        if(--p->running == 0){
+            pthread_cond_signal(&p->done);
+        }
+        pthread_mutex_unlock(&p->lock);
+    }
+}
+
+static threadPool* poolCreate(int workers){
+    threadPool* p = calloc(1, sizeof(threadPool));
+    if(p == NULL){
+        allocationFailure();
+    }
+    p->threads = malloc(sizeof(pthread_t) * workers);
+    if(p->threads == NULL){
+        allocationFailure();
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for(int i = 0; i < workers; i++){
+        if(pthread_create(&p->threads[i], NULL, workerMain, p) != 0){
+            // Keep the workers that did start
+            fprintf(stderr, "Could not start worker thread.\n");
+            break;
+        }
+        p->workers++;
+    }
+    return p;
+}
+
+static void poolDestroy(threadPool* p){
+    if(p == NULL){
+        return;
+    }
+    pthread_mutex_lock(&p->lock);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for(int i = 0; i < p->workers; i++){
+        pthread_join(p->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->wake);
+    pthread_cond_destroy(&p->done);
+    free(p->threads);
+    free(p);
+}
+
+/*
+    Default thread count: MATRIX_NUM_THREADS if set, otherwise the
+    number of online processors.
+*/
+static int defaultThreadCount(){
+    const char* env = getenv("MATRIX_NUM_THREADS");
+    if(env != NULL && atoi(env) > 0){
+        return atoi(env);
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+void matrixSetNumThreads(int threads){
+    pthread_mutex_lock(&poolLock);
+    // Workers are started lazily by the next parallel call
+    poolDestroy(pool);
+    pool = NULL;
+    atomic_store(&threadCount, threads > 0 ? threads : defaultThreadCount());
+    pthread_mutex_unlock(&poolLock);
+}
+
+int matrixGetNumThreads(){
+    // Nested calls run serially
+    if(insideTask){
+        return 1;
+    }
+    int threads = atomic_load(&threadCount);
+    if(threads == 0){
+        // Only the first caller stores the default; the others read its value
+        int expected = 0;
+        threads = defaultThreadCount();
+        if(!atomic_compare_exchange_strong(&threadCount, &expected, threads)){
+            threads = expected;
+        }
+    }
+    return threads;
+}
+
+void matrixParallelFor(int count, int grain, matrixTaskFn fn, void* arg){
+    if(count <= 0){
+        return;
+    }
+    if(grain < 1){
+        grain = 1;
+    }
+    // Nested calls, single chunks and busy pools run on the calling thread
+    if(insideTask || count <= grain || pthread_mutex_trylock(&poolLock) != 0){
+        fn(arg, 0, count);
+        return;
+    }
+    int threads = matrixGetNumThreads();
+    if(threads == 1){
+        pthread_mutex_unlock(&poolLock);
+        fn(arg, 0, count);
+        return;
+    }
+    if(pool == NULL){
+        pool = poolCreate(threads - 1);
+    }
+    threadPool* p = pool;
+
+    // Publish the job and wake all workers
+    pthread_mutex_lock(&p->lock);
+    p->fn = fn;
+    p->arg = arg;
+    p->count = count;
+    p->grain = grain;
+    atomic_store(&p->next, 0);
+    p->running = p->workers;
+    p->generation++;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+
+    // Work alongside the pool, then wait for the stragglers
+    insideTask = 1;
+    runChunks(p);
+    insideTask = 0;
+    pthread_mutex_lock(&p->lock);
+    while(p->running > 0){
+        pthread_cond_wait(&p->done, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    pthread_mutex_unlock(&poolLock);
+}
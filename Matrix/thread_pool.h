@@ -0,0 +1,37 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/**
+ * Task executed by the thread pool for a half-open range [begin, end)
+ * of work items.
+ * @param arg User data passed to matrixParallelFor
+ * @param begin First work item of the range
+ * @param end One past the last work item of the range
+ */
+typedef void (*matrixTaskFn)(void* arg, int begin, int end);
+
+/**
+ * Run `fn` over the work items [0, count) using the persistent worker pool.
+ * Items are handed out in chunks of `grain` items; the calling thread
+ * takes part in the work and the function returns when all items are done.
+ * When only one thread is configured, the pool is busy with another call,
+ * or the function is called from inside a task, everything runs on the
+ * calling thread.
+ * @param count Number of work items
+ * @param grain Number of items per chunk (values below 1 are treated as 1)
+ * @param fn Task function
+ * @param arg User data passed to every call of `fn`
+ */
+void matrixParallelFor(int count, int grain, matrixTaskFn fn, void* arg);
+
+/**
+ * Call `fn(arg)` when the calling thread exits, e.g. to free a per-thread
+ * (_Thread_local) buffer; the worker threads exit whenever the pool is
+ * resized. Handlers run in reverse order of registration. They do not
+ * run for the main thread, whose memory is released with the process.
+ * @param fn Cleanup function
+ * @param arg Argument passed to `fn`
+ */
+void matrixAtThreadExit(void (*fn)(void* arg), void* arg);
+
+#endif /* THREAD_POOL_H */
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <math.h>
 #include "hash_table.h"
@@ -11,69 +12,282 @@ _Noreturn static void allocationFailure(){
     exit(EXIT_FAILURE);
 }
 
-// Simple hash function: sum ASCII values of characters modulo table size
-static unsigned int hash(const char* key, unsigned int size) {
-    unsigned int hashValue = 0;
-    // Iterate through each character of the string
-    while (*key) {
-        hashValue += *key;
-        key++;
-    }
-    return hashValue % size;
+// Secret constants of the hash function (odd, with balanced bits)
+static const uint64_t hashSecret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+// Multiply two 64-bit values into 128 bits, returning the low half in *a and the high half in *b
+static inline void hashMultiply(uint64_t* a, uint64_t* b){
+#ifdef __SIZEOF_INT128__
+    __uint128_t product = (__uint128_t)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    uint64_t aHigh = *a >> 32, aLow = (uint32_t)*a, bHigh = *b >> 32, bLow = (uint32_t)*b;
+    uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow, middle1 = aLow * bHigh, low = aLow * bLow;
+    uint64_t t = low + (middle0 << 32);
+    uint64_t carry = t < low;
+    uint64_t lowResult = t + (middle1 << 32);
+    carry += lowResult < t;
+    *a = lowResult;
+    *b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
 }
 
-// Handle collision using quadratic probing
-static int addressCollision(hashTable* table, unsigned int index, const char* key){
-    if(table == NULL){
-        fprintf(stderr, "Table doesn't exist.\n");
-        exit(EXIT_FAILURE);
+// Fold the 128-bit product of two values into 64 bits
+static inline uint64_t hashMix(uint64_t a, uint64_t b){
+    hashMultiply(&a, &b);
+    return a ^ b;
+}
+
+// Read 8 or 4 bytes in native byte order from a possibly unaligned address
+static inline uint64_t hashRead8(const unsigned char* p){
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hashRead4(const unsigned char* p){
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Hash a string: short keys are read with a few overlapping loads, long ones 48 or 16 bytes at a time
+uint64_t hashTableHash(const char* key, uint64_t seed){
+    const unsigned char* p = (const unsigned char*)key;
+    size_t length = strlen(key);
+    uint64_t a, b;
+    seed ^= hashMix(seed ^ hashSecret[0], hashSecret[1]);
+    if(length <= 16){
+        if(length >= 4){
+            // Two overlapping pairs of 4-byte loads cover 4 to 16 bytes
+            size_t shift = (length >> 3) << 2;
+            a = (hashRead4(p) << 32) | hashRead4(p + shift);
+            b = (hashRead4(p + length - 4) << 32) | hashRead4(p + length - 4 - shift);
+        }
+        else if(length > 0){
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) | p[length - 1];
+            b = 0;
+        }
+        else{
+            a = b = 0;
+        }
+    }
+    else{
+        size_t i = length;
+        // Three independent lanes for long keys
+        if(i > 48){
+            uint64_t see1 = seed, see2 = seed;
+            do{
+                seed = hashMix(hashRead8(p) ^ hashSecret[1], hashRead8(p + 8) ^ seed);
+                see1 = hashMix(hashRead8(p + 16) ^ hashSecret[2], hashRead8(p + 24) ^ see1);
+                see2 = hashMix(hashRead8(p + 32) ^ hashSecret[3], hashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while(i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while(i > 16){
+            seed = hashMix(hashRead8(p) ^ hashSecret[1], hashRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        // The last 16 bytes of the key, overlapping bytes already mixed in
+        a = hashRead8(p + i - 16);
+        b = hashRead8(p + i - 8);
     }
-    unsigned int newIndex;
+    a ^= hashSecret[1];
+    b ^= seed;
+    hashMultiply(&a, &b);
+    return hashMix(a ^ hashSecret[0] ^ length, b ^ hashSecret[1]);
+}
+
+// Find the slot of a key using quadratic probing: the index of the live element
+// holding the key (setting *found), or else the first empty or deleted slot where
+// it can be inserted, or -1 if the probe sequence has neither
+static int findSlot(hashTable* table, const char* key, uint64_t keyHash, bool* found){
+    unsigned int mask = table->size - 1;
+    unsigned int index = (unsigned int)keyHash & mask;
+    int freeSlot = -1;
+    *found = false;
     // Try all possible positions in the table
-    for(int i = 0; i < table->size; i++){
-        // Quadratic probing formula
-        newIndex = (index + table->c1 * i + table->c2 * i * i) % table->size;
-        
-        // If the slot is empty or marked deleted, return it
-        if(table->table[newIndex] == NULL || table->table[newIndex]->deleted == true){
-            return newIndex;
+    for(unsigned int i = 0; i < table->size; i++){
+        // Quadratic probing formula, wrapping around modulo the power-of-two size
+        unsigned int newIndex = (index + (unsigned int)table->c1 * i + (unsigned int)table->c2 * i * i) & mask;
+        hashTableElement* element = table->table[newIndex];
+
+        // An empty slot ends the probe sequence
+        if(element == NULL){
+            return freeSlot >= 0 ? freeSlot : (int)newIndex;
+        }
+        // Remember the first deleted slot, the key may still follow it
+        if(element->deleted == true){
+            if(freeSlot < 0){
+                freeSlot = (int)newIndex;
+            }
+        }
+        // Compare the hashes first, the keys only when they match
+        else if(element->hash == keyHash && strcmp(element->key, key) == 0){
+            *found = true;
+            return (int)newIndex;
+        }
+    }
+    return freeSlot;
+}
+
+// Number of occupied slots a table of the given capacity may hold, always leaving
+// an empty slot so every probe sequence ends
+static unsigned int slotLimit(unsigned int capacity, double maxLoadFactor){
+    unsigned int limit = (unsigned int)(maxLoadFactor * capacity);
+    return limit < capacity ? limit : capacity - 1;
+}
+
+// Smallest power-of-two capacity holding count elements within the maximum load factor
+static unsigned int capacityFor(hashTable* table, unsigned long long count){
+    unsigned int capacity = 1;
+    while(capacity < HASH_TABLE_MAX_SIZE && count > slotLimit(capacity, table->maxLoadFactor)){
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+// Move all live elements into a new array of the given capacity and free the deleted ones;
+// the stored hashes are reused, so no key is hashed again
+static void rehash(hashTable* table, unsigned int capacity){
+    hashTableElement** slots = calloc(capacity, sizeof(hashTableElement*));
+    if(slots == NULL){
+        allocationFailure();
+    }
+    unsigned int mask = capacity - 1;
+
+    for(unsigned int i = 0; i < table->size; i++){
+        hashTableElement* element = table->table[i];
+        if(element == NULL){
+            continue;
+        }
+        if(element->deleted == true){
+            free(element->key);
+            free(element);
+            continue;
         }
-        // If the key already exists, free old element and return index
-        if(strcmp(table->table[newIndex]->key, key) == 0){
-            free(table->table[newIndex]->key);
-            free(table->table[newIndex]);
-            return newIndex;
+        // All keys are distinct, so the first empty slot of the probe sequence is the right one
+        unsigned int index = (unsigned int)element->hash & mask;
+        for(unsigned int j = 0; ; j++){
+            unsigned int newIndex = (index + (unsigned int)table->c1 * j + (unsigned int)table->c2 * j * j) & mask;
+            if(slots[newIndex] == NULL){
+                slots[newIndex] = element;
+                break;
+            }
         }
     }
-    // Return -1 if no free slot found
-    return -1;
+
+    free(table->table);
+    table->table = slots;
+    table->size = capacity;
+    table->used = table->count;
+    table->limit = slotLimit(capacity, table->maxLoadFactor);
+}
+
+// Make room for one more element: drop the deleted elements, and double the table
+// unless they alone filled it, so rehashing stays rare whatever the mix of operations
+static void growForInsert(hashTable* table){
+    unsigned int capacity = capacityFor(table, (unsigned long long)table->count + 1);
+    if(capacity < table->size){
+        capacity = table->size;
+    }
+    if(capacity == table->size && table->count + 1 > table->limit / 2 && table->size < HASH_TABLE_MAX_SIZE){
+        capacity = table->size * 2;
+    }
+    // A full table of the largest size without deleted elements cannot be helped
+    if(capacity != table->size || table->used != table->count){
+        rehash(table, capacity);
+    }
 }
 
 // Create a new hash table with given size and quadratic probing constants
 hashTable* hashTableCreate(unsigned int size, int c1, int c2){
+    return hashTableCreateSeeded(size, c1, c2, HASH_TABLE_DEFAULT_SEED);
+}
+
+// Create a new hash table with a power-of-two size and a seeded hash function
+hashTable* hashTableCreateSeeded(unsigned int size, int c1, int c2, uint64_t seed){
+    if(size > HASH_TABLE_MAX_SIZE){
+        fprintf(stderr, "Table size is too large.\n");
+        return NULL;
+    }
+    // Only these coefficients make the probe sequence visit every slot of a power-of-two table
+    if(c1 % 2 == 0 || c2 % 2 != 0){
+        fprintf(stderr, "Probing needs an odd c1 and an even c2.\n");
+        return NULL;
+    }
+
+    // Round the size up to a power of two
+    unsigned int capacity = 1;
+    while(capacity < size){
+        capacity <<= 1;
+    }
+
     // Allocate memory for hash table structure
     hashTable* table = malloc(sizeof(hashTable));
     if(table == NULL){
         allocationFailure();
     }
 
-    // Allocate memory for the array of pointers to elements
-    table->table = malloc(sizeof(hashTableElement*) * size);
+    // Allocate memory for the array of pointers to elements, all slots set to NULL
+    table->table = calloc(capacity, sizeof(hashTableElement*));
     if(table->table == NULL){
         allocationFailure();
     }
 
-    // Initialize all slots to NULL
-    for(int i = 0; i < size; i++){
-        table->table[i] = NULL;
-    }
-    table->size = size;
+    table->size = capacity;
     table->c1 = c1;
     table->c2 = c2;
+    table->seed = seed;
+    table->count = 0;
+    table->used = 0;
+    table->maxLoadFactor = HASH_TABLE_DEFAULT_MAX_LOAD_FACTOR;
+    table->limit = slotLimit(capacity, table->maxLoadFactor);
 
     return table;
 }
 
+// Set the maximum load factor, rehashing at once if the table exceeds it
+void hashTableSetMaxLoadFactor(hashTable* table, double maxLoadFactor){
+    if(table == NULL){
+        fprintf(stderr, "Table doesn't exist.\n");
+        return;
+    }
+    if(!(maxLoadFactor > 0 && maxLoadFactor < 1)){
+        fprintf(stderr, "Maximum load factor must be between 0 and 1.\n");
+        return;
+    }
+    table->maxLoadFactor = maxLoadFactor;
+    table->limit = slotLimit(table->size, maxLoadFactor);
+    hashTableReserve(table, table->count);
+}
+
+// Grow the table so that count elements fit within the maximum load factor
+void hashTableReserve(hashTable* table, unsigned int count){
+    if(table == NULL){
+        fprintf(stderr, "Table doesn't exist.\n");
+        return;
+    }
+    if(count < table->count){
+        count = table->count;
+    }
+    // Enough room if the new elements fit beside the deleted ones
+    if((unsigned long long)table->used - table->count + count <= table->limit){
+        return;
+    }
+    unsigned int capacity = capacityFor(table, count);
+    if(capacity < table->size){
+        capacity = table->size;
+    }
+    rehash(table, capacity);
+}
+
 // Insert or update an element in the hash table
 void hashTableInsert(hashTable* table, const char* key, double value){
     if(table == NULL){
@@ -81,44 +295,52 @@ void hashTableInsert(hashTable* table, const char* key, double value){
         exit(EXIT_FAILURE);
     }
 
-    // Compute initial hash index
-    unsigned int index = hash(key, table->size);
+    // Find the key, or the slot to insert it into
+    uint64_t keyHash = hashTableHash(key, table->seed);
+    bool found;
+    int index = findSlot(table, key, keyHash, &found);
 
-    // Allocate memory for new element
-    hashTableElement* element = malloc(sizeof(hashTableElement));
-    if(element == NULL){
-        allocationFailure();
+    // If the key already exists, update its value
+    if(found){
+        table->table[index]->value = value;
+        return;
+    }
+    // Rehash before a new element takes the table past its maximum load factor
+    if((index == -1 || table->table[index] == NULL) && table->used >= table->limit){
+        growForInsert(table);
+        index = findSlot(table, key, keyHash, &found);
+    }
+    if(index == -1){
+        fprintf(stderr, "There is no space.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // If the slot was previously deleted, reuse its element
+    hashTableElement* element = table->table[index];
+    if(element != NULL){
+        free(element->key);
+    }
+    else{
+        table->used++;
+        // Allocate memory for new element
+        element = malloc(sizeof(hashTableElement));
+        if(element == NULL){
+            allocationFailure();
+        }
     }
 
     // Copy key and set value
     element->key = strdup(key);
+    if(element->key == NULL){
+        allocationFailure();
+    }
+    element->hash = keyHash;
     element->value = value;
     element->deleted = false;
 
-    // Handle collision or update existing element
-    if(table->table[index] != NULL && table->table[index]->deleted == false){
-        // If the key already exists, replace it
-        if(strcmp(table->table[index]->key, key) == 0){
-            free(table->table[index]->key);
-            free(table->table[index]);
-            table->table[index] = element;
-            return;
-        }
-        // Otherwise, find new slot using quadratic probing
-        index = addressCollision(table, index, key);
-        if(index == -1){
-            fprintf(stderr, "There is no space.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    // If the slot was previously deleted, reuse it
-    else if(table->table[index] != NULL && table->table[index]->deleted == true){
-        free(table->table[index]->key);
-        free(table->table[index]);
-    }
-
     // Insert element into table
     table->table[index] = element;
+    table->count++;
 }
 
 // Search for a value by key in the hash table
@@ -128,25 +350,14 @@ double hashTableSearch(hashTable* table, char* key){
         return NAN;
     }
 
-    // Compute initial hash index
-    unsigned int index = hash(key, table->size);
-    unsigned int newIndex;
-
-    // Iterate using quadratic probing
-    for(int i = 0; i < table->size; i++){
-        newIndex = (index + table->c1 * i + table->c2 * i * i) % table->size;
-        // If slot is empty, key not found
-        if(table->table[newIndex] == NULL){
-            return NAN;
-        }
-        // If slot contains key and is not deleted, return value
-        if(table->table[newIndex]->deleted == false && (strcmp(table->table[newIndex]->key, key) == 0)){
-            return table->table[newIndex]->value;
-        }
-    }
+    bool found;
+    int index = findSlot(table, key, hashTableHash(key, table->seed), &found);
 
     // Key not found
-    return NAN;    
+    if(!found){
+        return NAN;
+    }
+    return table->table[index]->value;
 }
 
 // Mark an element as deleted
@@ -156,18 +367,12 @@ void hashTableDelete(hashTable* table, char* key){
         return;
     }
 
-    // Compute initial hash index
-    unsigned int index = hash(key, table->size);
-    unsigned int newIndex;
-
-    // Iterate using quadratic probing to find the key
-    for(int i = 0; i < table->size; i++){
-        newIndex = (index + table->c1 * i + table->c2 * i * i) % table->size;
-        if(table->table[newIndex] != NULL && (strcmp(table->table[newIndex]->key, key) == 0)){
-            // Mark the element as deleted
-            table->table[newIndex]->deleted = true;
-            return;
-        }
+    bool found;
+    int index = findSlot(table, key, hashTableHash(key, table->seed), &found);
+    if(found){
+        // Mark the element as deleted, its slot stays occupied until the next rehash
+        table->table[index]->deleted = true;
+        table->count--;
     }
 }
 
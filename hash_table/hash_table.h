@@ -1,6 +1,24 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Seed used by hashTableCreate.
+ */
+#define HASH_TABLE_DEFAULT_SEED 0x2d358dccaa6c78a5ULL
+
+/**
+ * Largest number of slots of a hash table.
+ */
+#define HASH_TABLE_MAX_SIZE (1u << 30)
+
+/**
+ * Maximum load factor of new tables (see hashTableSetMaxLoadFactor).
+ */
+#define HASH_TABLE_DEFAULT_MAX_LOAD_FACTOR 0.75
+
 /**
  * @struct hashTableElement
  * @brief Structure representing a single element in the hash table.
@@ -10,6 +28,7 @@
  */
 typedef struct {
     char* key;     /** Pointer to the string key */
+    uint64_t hash; /** Hash of the key, compared before the key itself */
     double value;  /** Value associated with the key */
     bool deleted;  /** Flag indicating logical deletion */
 } hashTableElement;
@@ -18,30 +37,100 @@ typedef struct {
  * @struct hashTable
  * @brief Structure representing the entire hash table.
  *
- * Contains a table of pointers to elements, its size,
- * and coefficients used in double hashing.
+ * Contains a table of pointers to elements, its size (a power of two,
+ * so slots are found by masking the hash), the seed of the hash function,
+ * the coefficients of quadratic probing and the counters that decide
+ * when the table grows.
  */
 typedef struct {
     hashTableElement** table; /** Pointer to the array of hash table elements */
-    unsigned int size;        /** Size of the hash table (number of slots) */
-    int c1;                   /** First coefficient for double hashing */
-    int c2;                   /** Second coefficient for double hashing */
+    unsigned int size;        /** Size of the hash table (number of slots, a power of two) */
+    int c1;                   /** Linear coefficient of quadratic probing */
+    int c2;                   /** Quadratic coefficient of quadratic probing */
+    uint64_t seed;            /** Seed of the hash function */
+    unsigned int count;       /** Number of elements not marked as deleted */
+    unsigned int used;        /** Number of occupied slots, deleted elements included */
+    unsigned int limit;       /** Number of occupied slots the table may hold before it is rehashed */
+    double maxLoadFactor;     /** Largest fraction of occupied slots, deleted elements included */
 } hashTable;
 
 /**
  * @brief Creates a new hash table.
  *
- * @param size Number of slots in the table
- * @param c1 First coefficient for double hashing
- * @param c2 Second coefficient for double hashing
- * @return Pointer to the newly created hash table
+ * The number of slots is rounded up to a power of two, and doubles
+ * whenever insertions would push the load factor above the maximum
+ * (HASH_TABLE_DEFAULT_MAX_LOAD_FACTOR by default). Slot i of the probe
+ * sequence of a key is (hash + c1 * i + c2 * i * i) masked to the table
+ * size, which visits every slot only when c1 is odd and c2 is even
+ * (e.g. 1 and 0 for linear probing, or 1 and 2).
+ *
+ * @param size Number of slots in the table (at most HASH_TABLE_MAX_SIZE)
+ * @param c1 Linear coefficient of quadratic probing (odd)
+ * @param c2 Quadratic coefficient of quadratic probing (even)
+ * @return Pointer to the newly created hash table, or NULL if the arguments are invalid
  */
 hashTable* hashTableCreate(unsigned int size, int c1, int c2);
 
+/**
+ * @brief Creates a new hash table whose hash function uses the given seed.
+ *
+ * Keys chosen to collide under one seed are spread evenly under another,
+ * so a secret random seed protects tables filled with untrusted keys
+ * against hash flooding.
+ *
+ * @param size Number of slots in the table (at most HASH_TABLE_MAX_SIZE)
+ * @param c1 Linear coefficient of quadratic probing (odd)
+ * @param c2 Quadratic coefficient of quadratic probing (even)
+ * @param seed Seed of the hash function
+ * @return Pointer to the newly created hash table, or NULL if the arguments are invalid
+ */
+hashTable* hashTableCreateSeeded(unsigned int size, int c1, int c2, uint64_t seed);
+
+/**
+ * @brief Computes the 64-bit hash of a string used by the hash table.
+ *
+ * A wyhash-style function: keys below 4 bytes are read byte by byte, keys
+ * up to 16 bytes with overlapping 4-byte loads, and longer keys 16 or 48
+ * bytes at a time in 8-byte loads. The words are mixed with 64 × 64 →
+ * 128-bit multiplications, so every byte affects every bit of the result.
+ *
+ * @param key Key string
+ * @param seed Seed of the hash function
+ * @return Hash of the key
+ */
+uint64_t hashTableHash(const char* key, uint64_t seed);
+
+/**
+ * @brief Sets the maximum load factor of the hash table.
+ *
+ * The load factor counts elements marked as deleted, since they lengthen
+ * probe sequences like live ones. When an insertion would exceed it, the
+ * table is rehashed without the deleted elements, into twice as many
+ * slots unless the deleted elements alone made it full. Lowering the
+ * factor rehashes the table right away if needed.
+ *
+ * @param table Pointer to the hash table
+ * @param maxLoadFactor Maximum load factor, greater than 0 and less than 1
+ */
+void hashTableSetMaxLoadFactor(hashTable* table, double maxLoadFactor);
+
+/**
+ * @brief Makes room for a number of elements without further rehashing.
+ *
+ * Grows the table, if needed, so that it holds `count` elements within
+ * its maximum load factor, e.g. before a bulk load of known size.
+ * The table never shrinks.
+ *
+ * @param table Pointer to the hash table
+ * @param count Number of elements to make room for
+ */
+void hashTableReserve(hashTable* table, unsigned int count);
+
 /**
  * @brief Inserts a key-value pair into the hash table.
  *
- * If the key already exists, its value is updated.
+ * If the key already exists, its value is updated. The table grows
+ * automatically to keep its load factor below the maximum.
  *
  * @param table Pointer to the hash table
  * @param key Key string
@@ -6,7 +6,7 @@
 
 int main(){
     // Create hash table with size 10 and quadratic probing constants
-    hashTable* table = hashTableCreate(10, 1, 3);
+    hashTable* table = hashTableCreate(10, 1, 2);
 
     // Insert elements
     hashTableInsert(table, "banana", 5.5);
@@ -46,8 +46,26 @@ int main(){
         printf("pomegranate not found (ok)\n");
     } 
 
+    // Insert many more elements than the initial size: the table grows automatically
+    char key[32];
+    for(int i = 0; i < 100; i++){
+        sprintf(key, "fruit-%d", i);
+        hashTableInsert(table, key, i);
+    }
+    printf("%u elements in %u slots\n", table->count, table->size);
+
     // Free all allocated memory
     hashTableFree(table);
 
+    // Reserve room before a bulk load of known size, so no rehashing happens during it
+    table = hashTableCreate(0, 1, 2);
+    hashTableReserve(table, 1000);
+    for(int i = 0; i < 1000; i++){
+        sprintf(key, "/items/%d", i);
+        hashTableInsert(table, key, i);
+    }
+    printf("/items/500 -> %.2lf\n", hashTableSearch(table, "/items/500"));
+    hashTableFree(table);
+
     return 0;
 }